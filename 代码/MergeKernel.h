@@ -0,0 +1,109 @@
+#ifndef MERGE_KERNEL_H
+#define MERGE_KERNEL_H
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MERGE_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+/**
+ * 两个有序int数组的归并：out = merge(a[0..na), b[0..nb))，相等时a在前
+ * 逐个比较的归并每输出一个元素都要走一次依赖数据的分支，随机数据上约一半预测失败。
+ * 1. 两边都有至少8个元素且CPU支持AVX2时，每步把两个寄存器（各8个有序元素）做一次双调归并：
+ *    较小的8个写出，较大的8个留在寄存器里，再从表头较小的一边装入下一组8个
+ * 2. 剩下不足一组的部分用无分支的标量归并：比较结果直接用作下标增量，编译成cmov
+ * 可以被Sort.cpp和独立编译的SequenceList.cpp共同包含，所以全部写在头文件里。
+ */
+
+static inline void MergeScalarInt(const int a[], int na, const int b[], int nb,
+                                  int out[]) { // 无分支标量归并
+  int i = 0, j = 0, k = 0;
+  while (i < na && j < nb) {
+    int x = a[i], y = b[j];
+    int takeB = y < x; // 相等时取a，保持稳定
+    out[k++] = takeB ? y : x;
+    j += takeB;
+    i += 1 - takeB;
+  }
+  memcpy(out + k, a + i, (na - i) * sizeof(int));
+  memcpy(out + k + na - i, b + j, (nb - j) * sizeof(int));
+}
+
+#ifdef MERGE_HAVE_AVX2
+__attribute__((target("avx2"))) static inline void
+BitonicMerge8x8(__m256i &lo, __m256i &hi) { // lo、hi各自升序，归并后lo为最小的8个，hi为其余8个，均升序
+  /**
+   * 把hi倒序后与lo拼成16个元素的双调序列，先做距离8的比较交换，
+   * 两半各自仍是双调序列，再在寄存器内依次做距离4、2、1的比较交换。
+   * 两个寄存器的步骤互不依赖，交错排列，让乱序执行并行处理。
+   */
+  hi = _mm256_permutevar8x32_epi32(hi, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+  __m256i l = _mm256_min_epi32(lo, hi), h = _mm256_max_epi32(lo, hi);
+
+  __m256i pl = _mm256_permute2x128_si256(l, l, 1), ph = _mm256_permute2x128_si256(h, h, 1);
+  l = _mm256_blend_epi32(_mm256_min_epi32(l, pl), _mm256_max_epi32(l, pl), 0xF0);
+  h = _mm256_blend_epi32(_mm256_min_epi32(h, ph), _mm256_max_epi32(h, ph), 0xF0);
+
+  pl = _mm256_shuffle_epi32(l, _MM_SHUFFLE(1, 0, 3, 2));
+  ph = _mm256_shuffle_epi32(h, _MM_SHUFFLE(1, 0, 3, 2));
+  l = _mm256_blend_epi32(_mm256_min_epi32(l, pl), _mm256_max_epi32(l, pl), 0xCC);
+  h = _mm256_blend_epi32(_mm256_min_epi32(h, ph), _mm256_max_epi32(h, ph), 0xCC);
+
+  pl = _mm256_shuffle_epi32(l, _MM_SHUFFLE(2, 3, 0, 1));
+  ph = _mm256_shuffle_epi32(h, _MM_SHUFFLE(2, 3, 0, 1));
+  lo = _mm256_blend_epi32(_mm256_min_epi32(l, pl), _mm256_max_epi32(l, pl), 0xAA);
+  hi = _mm256_blend_epi32(_mm256_min_epi32(h, ph), _mm256_max_epi32(h, ph), 0xAA);
+}
+
+__attribute__((target("avx2"))) static void
+MergeAVX2Int(const int a[], int na, const int b[], int nb, int out[]) { // na、nb都不少于8
+  __m256i lo = _mm256_loadu_si256((const __m256i *)a);
+  __m256i hi = _mm256_loadu_si256((const __m256i *)b);
+  int i = 8, j = 8, k = 0;
+  for (;;) {
+    BitonicMerge8x8(lo, hi);
+    _mm256_storeu_si256((__m256i *)(out + k), lo);
+    k += 8;
+    if (i + 8 > na || j + 8 > nb) // 有一边凑不满一组，转入收尾
+      break;
+    int takeA = a[i] <= b[j]; // 下一组取表头较小的一边，用条件赋值代替分支
+    const int *src = takeA ? a + i : b + j;
+    i += 8 * takeA;
+    j += 8 * (1 - takeA);
+    lo = _mm256_loadu_si256((const __m256i *)src);
+  }
+  /**
+   * 收尾时还剩三段有序序列：寄存器里的8个，不足一组的一边，以及另一边剩下的部分。
+   * 先把前两段归并到栈上（不超过15个），再与第三段归并。
+   */
+  int h[8], t[15];
+  _mm256_storeu_si256((__m256i *)h, hi);
+  if (i + 8 > na) {
+    MergeScalarInt(h, 8, a + i, na - i, t);
+    MergeScalarInt(t, 8 + na - i, b + j, nb - j, out + k);
+  } else {
+    MergeScalarInt(h, 8, b + j, nb - j, t);
+    MergeScalarInt(t, 8 + nb - j, a + i, na - i, out + k);
+  }
+}
+
+static inline bool MergeHasAVX2() { // CPUID检测，只检测一次
+  static const bool has = __builtin_cpu_supports("avx2");
+  return has;
+}
+#endif
+
+static inline void MergeSortedInt(const int a[], int na, const int b[], int nb,
+                                  int out[]) { // out不能与a、b重叠
+#ifdef MERGE_HAVE_AVX2
+  if (na >= 8 && nb >= 8 && MergeHasAVX2()) {
+    MergeAVX2Int(a, na, b, nb, out);
+    return;
+  }
+#endif
+  MergeScalarInt(a, na, b, nb, out);
+}
+
+#endif // MERGE_KERNEL_H
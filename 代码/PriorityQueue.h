@@ -0,0 +1,244 @@
+#ifndef PRIORITY_QUEUE_H
+#define PRIORITY_QUEUE_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * D叉堆（默认4叉），堆顶为Less意义下最小的元素
+ * 结点i的孩子为D*i+1..D*i+D，双亲为(i-1)/D。
+ * 相比二叉堆层数少一半，每层多比较几次孩子，但这几个孩子在内存中相邻，
+ * 取一层只需一次缓存访问。
+ */
+template <int D> struct DAryHeap {
+  static_assert(D >= 2, "arity must be at least 2");
+
+  struct NoMove { // 默认不需要记录元素位置
+    void operator()(size_t) const {}
+  };
+
+  static size_t Parent(size_t i) { return (i - 1) / D; }
+  static size_t FirstChild(size_t i) { return D * i + 1; }
+
+  template <class T, class Less, class Moved = NoMove>
+  static void SiftUp(T a[], size_t i, Less &less, Moved moved = Moved()) {
+    T x = std::move(a[i]);
+    while (i > 0 && less(x, a[Parent(i)])) {
+      a[i] = std::move(a[Parent(i)]);
+      moved(i);
+      i = Parent(i);
+    }
+    a[i] = std::move(x);
+    moved(i);
+  }
+
+  template <class T, class Less, class Moved = NoMove>
+  static void SiftDown(T a[], size_t i, size_t n, Less &less,
+                       Moved moved = Moved()) { // Floyd自底向上调整
+    /**
+     * HeadAdjust每层要比较两次：先找较大的孩子，再和根比较。
+     * 这里先不和根比较，一路把最优的孩子往上提，让空位直接落到叶子，
+     * 再把原来的根从叶子往上调。被调整的元素通常本来就来自堆底，往上走不了几层，
+     * 每层约省一次比较。
+     */
+    T x = std::move(a[i]);
+    size_t top = i;
+    for (size_t c = FirstChild(i); c < n; c = FirstChild(i)) {
+      size_t best = c;
+      if (c + D <= n) { // 孩子满D个时循环次数固定，可完全展开
+        for (int k = 1; k < D; k++) // 写成条件赋值，编译器可生成cmov，避免难预测的分支
+          best = less(a[c + k], a[best]) ? c + k : best;
+      } else {
+        for (size_t k = c + 1; k < n; k++)
+          best = less(a[k], a[best]) ? k : best;
+      }
+      a[i] = std::move(a[best]);
+      moved(i);
+      i = best;
+    }
+    while (i > top && less(x, a[Parent(i)])) {
+      a[i] = std::move(a[Parent(i)]);
+      moved(i);
+      i = Parent(i);
+    }
+    a[i] = std::move(x);
+    moved(i);
+  }
+
+  template <class T, class Less, class Moved = NoMove>
+  static void Heapify(T a[], size_t n, Less &less,
+                      Moved moved = Moved()) { // O(n)建堆
+    if (n < 2)
+      return;
+    for (size_t i = Parent(n - 1) + 1; i-- > 0;)
+      SiftDown(a, i, n, less, moved);
+  }
+};
+
+/**
+ * 优先队列，支持按句柄修改关键字
+ * Push返回句柄，之后可用DecreaseKey把该元素改得更靠前。
+ * 句柄低32位为元素编号，高位为该编号的代数：编号在元素弹出后会被复用，
+ * 每复用一次代数加一，旧句柄的代数对不上，Contains即为false。
+ * 存储按64字节对齐，并在数组前空出D-1个位置，
+ * 使每组兄弟结点（D*i+1..D*i+D）从组的整数倍处开始，D*sizeof(Entry)不超过64字节时同在一个缓存行。
+ */
+template <class T, int D = 4, class Comp = std::less<T>> class PriorityQueue {
+public:
+  typedef long long Handle;
+
+  PriorityQueue() : buf_(NULL), a_(NULL), size_(0), cap_(0) {}
+  ~PriorityQueue() { Release(); }
+  PriorityQueue(const PriorityQueue &) = delete;
+  PriorityQueue &operator=(const PriorityQueue &) = delete;
+
+  int Size() const { return (int)size_; }
+  bool Empty() const { return size_ == 0; }
+  bool Contains(Handle h) const { // 元素已弹出、或编号已被复用时为false
+    if (h < 0)
+      return false;
+    size_t id = (size_t)(h & 0xffffffff);
+    return id < pos_.size() && pos_[id] >= 0 && gen_[id] == (unsigned)(h >> 32);
+  }
+  const T &Top() const { return a_[0].value; } // 队列非空时才能调用
+
+  Handle Push(const T &x) {
+    Reserve(size_ + 1);
+    int id = NewId();
+    new (&a_[size_]) Entry{x, id};
+    pos_[id] = size_;
+    size_++;
+    DAryHeap<D>::SiftUp(a_, size_ - 1, less_, Track(this));
+    return MakeHandle(id);
+  }
+
+  T Pop() { // 弹出并返回堆顶，队列非空时才能调用
+    T top = std::move(a_[0].value);
+    Retire(a_[0].id);
+    size_--;
+    if (size_ > 0) {
+      a_[0] = std::move(a_[size_]);
+      pos_[a_[0].id] = 0;
+      DAryHeap<D>::SiftDown(a_, 0, size_, less_, Track(this));
+    }
+    a_[size_].~Entry();
+    return top;
+  }
+
+  void DecreaseKey(Handle h, const T &x) { // h须有效（Contains为真），新关键字不能比原来靠后
+    size_t i = pos_[h & 0xffffffff];
+    a_[i].value = x;
+    DAryHeap<D>::SiftUp(a_, i, less_, Track(this));
+  }
+
+  void Heapify(const T data[], int n,
+               Handle handles[] = NULL) { // 用data[0..n)替换当前内容，O(n)建堆，handles非空时写入各元素的句柄
+    Clear();
+    Reserve(n);
+    pos_.resize(n);
+    if (gen_.size() < pos_.size())
+      gen_.resize(pos_.size(), 0);
+    for (int i = 0; i < n; i++) {
+      new (&a_[i]) Entry{data[i], i};
+      pos_[i] = i;
+      if (handles)
+        handles[i] = MakeHandle(i);
+    }
+    size_ = n;
+    DAryHeap<D>::Heapify(a_, size_, less_, Track(this));
+  }
+
+  void Clear() { // 旧句柄全部失效
+    for (size_t i = 0; i < size_; i++) {
+      Retire(a_[i].id);
+      a_[i].~Entry();
+    }
+    size_ = 0;
+    pos_.clear();
+    freeIds_.clear();
+  }
+
+private:
+  struct Entry {
+    T value;
+    int id; // 元素编号，即句柄的低32位
+  };
+
+  struct EntryLess {
+    Comp comp;
+    bool operator()(const Entry &x, const Entry &y) {
+      return comp(x.value, y.value);
+    }
+  };
+
+  struct Track { // 元素移动时更新句柄到位置的映射
+    PriorityQueue *q;
+    explicit Track(PriorityQueue *q) : q(q) {}
+    void operator()(size_t i) const { q->pos_[q->a_[i].id] = (long)i; }
+  };
+
+  static const size_t ALIGN = 64;
+
+  int NewId() {
+    if (!freeIds_.empty()) {
+      int id = freeIds_.back();
+      freeIds_.pop_back();
+      return id;
+    }
+    pos_.push_back(-1);
+    if (gen_.size() < pos_.size()) // Clear后gen_保留，编号重新从0开始时沿用原来的代数
+      gen_.push_back(0);
+    return (int)pos_.size() - 1;
+  }
+
+  Handle MakeHandle(int id) const {
+    return (Handle)((unsigned long long)gen_[id] << 32 | (unsigned)id);
+  }
+
+  void Retire(int id) { // 元素离开队列：编号放回空闲表，代数加一（只用31位，句柄恒非负）
+    pos_[id] = -1;
+    gen_[id] = (gen_[id] + 1) & 0x7fffffff;
+    freeIds_.push_back(id);
+  }
+
+  void Reserve(size_t need) {
+    if (need <= cap_)
+      return;
+    size_t cap = cap_ ? cap_ * 2 : 64;
+    while (cap < need)
+      cap *= 2;
+    Entry *buf = static_cast<Entry *>(::operator new(
+        (cap + D - 1) * sizeof(Entry), std::align_val_t(ALIGN)));
+    Entry *a = buf + (D - 1);
+    for (size_t i = 0; i < size_; i++) {
+      new (&a[i]) Entry(std::move(a_[i]));
+      a_[i].~Entry();
+    }
+    if (buf_)
+      ::operator delete(buf_, std::align_val_t(ALIGN));
+    buf_ = buf;
+    a_ = a;
+    cap_ = cap;
+  }
+
+  void Release() {
+    Clear();
+    if (buf_)
+      ::operator delete(buf_, std::align_val_t(ALIGN));
+    buf_ = a_ = NULL;
+    cap_ = 0;
+  }
+
+  Entry *buf_;               // 对齐分配的起始地址
+  Entry *a_;                 // 堆数组，a_ = buf_ + (D-1)
+  size_t size_, cap_;
+  std::vector<long> pos_;    // 句柄 -> 堆中下标，-1表示已弹出
+  std::vector<unsigned> gen_; // 编号 -> 当前代数，Clear时不清空
+  std::vector<int> freeIds_;
+  EntryLess less_;
+};
+
+#endif // PRIORITY_QUEUE_H
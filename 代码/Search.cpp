@@ -1,5 +1,17 @@
 #include "Search.h"
+#include <climits>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SEARCH_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
 
 int SearchSeq(SSTable ST, ElemType key) { // 顺序查找
   ST.elem[0] = key;                       // 哨兵，目的是为了不用处理越界情况
@@ -24,6 +36,196 @@ int BinarySearch(SSTable ST, ElemType key) { // 二分查找
              : -1; // 这里不用担心返回l还是r还是mid，跳出时候三者值相等
 }
 
+static int EytzingerFill(const ElemType a[], EytzingerTable &E, int i,
+                         int k) { // 中序遍历以k为根的子树，依次填入a[i..]，返回下一个未用的i
+  if (k <= E.n) {
+    i = EytzingerFill(a, E, i, 2 * k);
+    E.b[k] = a[i];
+    E.rank[k] = i;
+    i = EytzingerFill(a, E, i + 1, 2 * k + 1);
+  }
+  return i;
+}
+
+bool EytzingerBuild(SSTable ST, EytzingerTable &E) { // 把有序表转成Eytzinger布局
+  /**
+   * 二分查找前几次访问的mid总是那几个，之后每次都跳到很远的地方，表超过缓存后几乎每次都缺失。
+   * 这里把有序表看作一棵完全二叉树，按层序存放：结点k的孩子为2k和2k+1。
+   * 1. 越靠近根的元素越集中在数组前部，常被访问，一直留在缓存里
+   * 2. 结点k往下4层的16个后代正好是b[16k..16k+15]，b按64字节对齐时在同一个缓存行，
+   *    可以提前预取，把逐层等待的缺失重叠起来
+   * 中序遍历这棵树恰好是原来的有序序列，所以按中序依次填入即可，rank记录原下标。
+   */
+  E.n = ST.TableLen;
+  size_t bytes = ((size_t)E.n + 1) * sizeof(ElemType);
+  E.b = (ElemType *)aligned_alloc(64, (bytes + 63) / 64 * 64);
+  E.rank = (int *)malloc(((size_t)E.n + 1) * sizeof(int));
+  if (E.b == NULL || E.rank == NULL) {
+    EytzingerDestroy(E);
+    return false;
+  }
+  EytzingerFill(ST.elem, E, 0, 1);
+  return true;
+}
+
+static unsigned EytzingerDescend(const EytzingerTable &E,
+                                 ElemType key) { // 返回第一个>=key的结点，不存在返回0
+  /**
+   * 每层只做 k = 2k + (b[k] < key)，没有分支，不存在预测失败。
+   * 走到叶子以下后，k的二进制就是一路的左右选择（0左1右），
+   * 最后一次向左（即最后一个0）的位置就是第一个>=key的结点：去掉末尾的1和这个0即可还原。
+   * 全部向右说明所有元素都小于key，此时k还原为0。
+   */
+  unsigned k = 1;
+  while (k <= (unsigned)E.n) {
+    __builtin_prefetch(E.b + 16 * (size_t)k); // 4层之后要访问的缓存行
+    k = 2 * k + (E.b[k] < key);
+  }
+  return k >> __builtin_ffs(~k);
+}
+
+int EytzingerLowerBound(const EytzingerTable &E, ElemType key) { // Eytzinger布局上的下界查找
+  unsigned k = EytzingerDescend(E, key);
+  return k == 0 ? E.n : E.rank[k];
+}
+
+int EytzingerSearch(const EytzingerTable &E, ElemType key) { // 与BinarySearch结果相同
+  unsigned k = EytzingerDescend(E, key);
+  return k != 0 && E.b[k] == key ? E.rank[k] : -1;
+}
+
+void EytzingerDestroy(EytzingerTable &E) {
+  free(E.b);
+  free(E.rank);
+  E.b = NULL;
+  E.rank = NULL;
+  E.n = 0;
+}
+
+static long long STreeBlocks(long long m) { // m个键需要的结点数
+  return (m + STREE_B - 1) / STREE_B;
+}
+
+static long long STreeParentKeys(long long m) { // 下一层有m个键时，上一层的键数
+  return (STreeBlocks(m) + STREE_B) / (STREE_B + 1) * STREE_B; // 每STREE_B+1个孩子对应一个STREE_B键的结点
+}
+
+bool STreeBuild(SSTable ST, STree &T) { // 由有序表构建S-tree
+  /**
+   * 指针全部省去，结点位置靠计算得到：
+   * 1. 叶子层就是有序表本身，按STREE_B个一组切成结点，末尾用INT_MAX补齐，
+   *    所以叶子层中的位置就是原下标，不需要另存rank
+   * 2. 第h层第k个结点的第j个孩子是第h-1层第k*(STREE_B+1)+j个结点
+   * 3. 内部结点的第j个键是第j+1个孩子子树中的最小键（B+树的分隔键），没有该孩子时为INT_MAX
+   * 查找时每层只在一个缓存行内比较，层数约为log17(n/16)，10^8个元素只有6层。
+   */
+  T.n = ST.TableLen;
+  T.height = 0;
+  long long total = 0;
+  for (long long m = T.n;; m = STreeParentKeys(m)) {
+    T.offset[T.height++] = total;
+    total += (STreeBlocks(m) > 0 ? STreeBlocks(m) : 1) * STREE_B; // 空表也留一个结点
+    if (m <= STREE_B || T.height == STREE_MAX_HEIGHT)
+      break;
+  }
+  T.keys = (ElemType *)aligned_alloc(64, total * sizeof(ElemType));
+  if (T.keys == NULL)
+    return false;
+
+  long long leafEnd = T.height > 1 ? T.offset[1] : total;
+  for (long long i = 0; i < leafEnd; i++)
+    T.keys[i] = i < T.n ? ST.elem[i] : INT_MAX;
+  for (int h = 1; h < T.height; h++) {
+    long long end = h + 1 < T.height ? T.offset[h + 1] : total;
+    for (long long i = 0; T.offset[h] + i < end; i++) {
+      long long k = i / STREE_B, j = i % STREE_B;
+      long long c = k * (STREE_B + 1) + j + 1; // 第j+1个孩子
+      for (int l = 1; l < h; l++)              // 一直沿最左孩子下到叶子层
+        c *= STREE_B + 1;
+      T.keys[T.offset[h] + i] = c * STREE_B < T.n ? ST.elem[c * STREE_B] : INT_MAX;
+    }
+  }
+  return true;
+}
+
+#ifdef SEARCH_HAVE_AVX2
+__attribute__((target("avx2"))) static long long
+STreeDescendAVX2(const STree &T, ElemType key) { // 每个结点两次比较加movemask
+  __m256i x = _mm256_set1_epi32(key);
+  long long k = 0;
+  for (int h = T.height - 1; h >= 0; h--) {
+    const ElemType *node = T.keys + T.offset[h] + k * STREE_B;
+    __m256i lt0 = _mm256_cmpgt_epi32(x, _mm256_load_si256((const __m256i *)node));
+    __m256i lt1 = _mm256_cmpgt_epi32(x, _mm256_load_si256((const __m256i *)(node + 8)));
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(lt0)) |
+               _mm256_movemask_ps(_mm256_castsi256_ps(lt1)) << 8;
+    int i = __builtin_popcount(mask); // 结点内有序，小于key的键数即下降的位置
+    k = h > 0 ? k * (STREE_B + 1) + i : k * STREE_B + i;
+  }
+  return k;
+}
+
+static bool SearchHasAVX2() { // CPUID检测，只检测一次
+  static const bool has = __builtin_cpu_supports("avx2");
+  return has;
+}
+#endif
+
+static long long STreeDescend(const STree &T, ElemType key) { // 返回第一个>=key的叶子层下标
+  /**
+   * 从根往下，每层数出结点中小于key的键数i，走到第i个孩子。
+   * 等于key的分隔键不计入，所以会走到左边的孩子：重复元素跨过结点边界时也能找到第一个。
+   * 到叶子层时i可能为STREE_B，这恰好是下一个叶子结点的开头，结果仍然正确。
+   */
+#ifdef SEARCH_HAVE_AVX2
+  if (SearchHasAVX2())
+    return STreeDescendAVX2(T, key);
+#endif
+  long long k = 0;
+  for (int h = T.height - 1; h >= 0; h--) {
+    const ElemType *node = T.keys + T.offset[h] + k * STREE_B;
+    int i = 0;
+    for (int j = 0; j < STREE_B; j++) // 固定次数、无分支，编译器可自动向量化
+      i += node[j] < key;
+    k = h > 0 ? k * (STREE_B + 1) + i : k * STREE_B + i;
+  }
+  return k;
+}
+
+int STreeLowerBound(const STree &T, ElemType key) {
+  long long k = STreeDescend(T, key);
+  return k < T.n ? (int)k : T.n;
+}
+
+int STreeUpperBound(const STree &T, ElemType key) { // 整数键，第一个>key即第一个>=key+1
+  return key == INT_MAX ? T.n : STreeLowerBound(T, key + 1);
+}
+
+int STreeSearch(const STree &T, ElemType key) {
+  int i = STreeLowerBound(T, key);
+  return i < T.n && T.keys[i] == key ? i : -1;
+}
+
+STreeIter STreeRange(const STree &T, ElemType lo, ElemType hi) { // 叶子层连续存放，区间遍历就是顺序扫描
+  STreeIter it = {&T, STreeLowerBound(T, lo), STreeUpperBound(T, hi)};
+  if (it.end < it.pos)
+    it.end = it.pos;
+  return it;
+}
+
+bool STreeNext(STreeIter &it, ElemType &key) {
+  if (it.pos >= it.end)
+    return false;
+  key = it.T->keys[it.pos++];
+  return true;
+}
+
+void STreeDestroy(STree &T) {
+  free(T.keys);
+  T.keys = NULL;
+  T.n = T.height = 0;
+}
+
 BSTNode *BST_Search(BiTree T, ElemType key) { // 二叉排序树查找
   while (T != NULL && key != T->data) {
     if (key < T->data)
@@ -34,29 +236,1069 @@ BSTNode *BST_Search(BiTree T, ElemType key) { // 二叉排序树查找
   return T;
 }
 
-bool BSTInsert(BiTree &T, ElemType key) { // 二叉排序树插入
+// BST结点池
+
+typedef struct {        // 一棵树的结点池，每棵树独占一个，随第一个结点创建
+  void *slabs;          // slab链表
+  BSTNode *freeList;    // 回收的结点，借用lchild串成链表
+  char *cursor, *limit; // 当前slab中未分配部分
+  int live;             // 已分配未回收的结点数，降为0时整个池释放
+} BSTPool;
+
+typedef struct { // 每块slab的开头，后面紧跟结点
+  BSTPool *pool;
+  void *next;
+} BSTSlab;
+
+static const size_t BST_SLAB_HEADER = 64; // 头部占一个缓存行，结点从缓存行边界开始
+static const size_t BST_ARENA_BYTES = (size_t)1 << 34; // 预留给slab的地址空间，只在用到时才占物理内存
+
+typedef struct { // 所有结点池共用的slab来源
+  char *base;    // 预留区起始地址，按BST_SLAB_BYTES对齐；预留失败为NULL，此时结点逐个malloc
+  size_t used;   // 已切出的字节数
+  std::vector<char *> freeSlabs; // 释放后待复用的slab
+  std::mutex lock; // 只在申请、释放slab时加锁
+} BSTArena;
+
+static BSTArena &BSTGetArena() { // 第一次用到时预留地址空间（局部静态变量的初始化是线程安全的）
+  /**
+   * BiTree只是一个结点指针，没有地方存放池，所以池的地址写在slab头，
+   * slab按BST_SLAB_BYTES对齐，屏蔽结点地址的低位即得slab头，接口不必改变。
+   * 但只有确知结点在slab中才能这样读：手工malloc的结点屏蔽后的地址可能根本不可读。
+   * 所以slab全部从一段预留的地址空间中切出，判断结点是否来自结点池只需比较地址范围，
+   * 不读内存、不查表、不加锁。
+   */
+  static BSTArena *A = [] { // 故意不析构：其他静态对象析构时可能还要销毁树
+    BSTArena *a = new BSTArena();
+    a->base = NULL;
+    a->used = 0;
+#if defined(__unix__) || defined(__APPLE__)
+    void *m = mmap(NULL, BST_ARENA_BYTES + BST_SLAB_BYTES, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (m != MAP_FAILED) // mmap只保证按页对齐，多预留一块再向上对齐
+      a->base = (char *)(((uintptr_t)m + BST_SLAB_BYTES - 1) & ~(uintptr_t)(BST_SLAB_BYTES - 1));
+#endif
+    return a;
+  }();
+  return *A;
+}
+
+static bool BSTInArena(const void *p) { // 是否来自结点池，不解引用p
+  const BSTArena &A = BSTGetArena();
+  return A.base != NULL && (uintptr_t)p - (uintptr_t)A.base < BST_ARENA_BYTES;
+}
+
+static BSTSlab *BSTSlabAlloc() { // 取一块slab，预留区用尽返回NULL
+  BSTArena &A = BSTGetArena();
+  std::lock_guard<std::mutex> guard(A.lock);
+  if (!A.freeSlabs.empty()) {
+    char *slab = A.freeSlabs.back();
+    A.freeSlabs.pop_back();
+    return (BSTSlab *)slab;
+  }
+  if (A.base == NULL || A.used + BST_SLAB_BYTES > BST_ARENA_BYTES)
+    return NULL;
+  A.used += BST_SLAB_BYTES;
+  return (BSTSlab *)(A.base + A.used - BST_SLAB_BYTES);
+}
+
+static void BSTSlabRelease(BSTSlab *slab) { // 归还slab，物理内存交还系统，地址留待复用
+#if defined(__unix__) || defined(__APPLE__)
+  madvise(slab, BST_SLAB_BYTES, MADV_DONTNEED);
+#endif
+  BSTArena &A = BSTGetArena();
+  std::lock_guard<std::mutex> guard(A.lock);
+  A.freeSlabs.push_back((char *)slab);
+}
+
+static BSTPool *BSTPoolOf(const BSTNode *p) { // 结点所属的池，不是由结点池分配的（如手工建立的）返回NULL
+  if (!BSTInArena(p))
+    return NULL;
+  return ((BSTSlab *)((uintptr_t)p & ~(uintptr_t)(BST_SLAB_BYTES - 1)))->pool;
+}
+
+static BSTNode *BSTNewNode(BSTPool **P, ElemType key) { // 新建叶子结点
+  /**
+   * P为NULL时逐个malloc，用于往不是由结点池建立的树中插入；*P为NULL时先建池。
+   * 结点优先取回收链表，其次从当前slab顺序切分，用完再申请新slab：
+   * 同一棵树的结点挤在少数几块连续内存里，遍历时缓存和TLB命中都好于逐个malloc。
+   * 代价是每棵非空树至少占一块slab（BST_SLAB_BYTES字节）。
+   */
+  BSTNode *p;
+  if (P == NULL || (*P == NULL && BSTGetArena().base == NULL)) { // 无法预留地址空间时也逐个malloc
+    p = (BSTNode *)malloc(sizeof(BSTNode));
+    if (p == NULL)
+      return NULL;
+    p->data = key;
+    p->lchild = p->rchild = NULL;
+    p->count = p->height = p->dup = 1;
+    return p;
+  }
+  if (*P == NULL) {
+    *P = (BSTPool *)calloc(1, sizeof(BSTPool));
+    if (*P == NULL)
+      return NULL;
+  }
+  BSTPool *Q = *P;
+  p = Q->freeList;
+  if (p != NULL) {
+    Q->freeList = p->lchild;
+  } else {
+    if (Q->cursor + sizeof(BSTNode) > Q->limit) {
+      BSTSlab *slab = BSTSlabAlloc();
+      if (slab == NULL) {
+        if (Q->live == 0) { // 刚建的空池
+          free(Q);
+          *P = NULL;
+        }
+        return NULL;
+      }
+      slab->pool = Q;
+      slab->next = Q->slabs;
+      Q->slabs = slab;
+      Q->cursor = (char *)slab + BST_SLAB_HEADER;
+      Q->limit = (char *)slab + BST_SLAB_BYTES;
+    }
+    p = (BSTNode *)Q->cursor;
+    Q->cursor += sizeof(BSTNode);
+  }
+  Q->live++;
+  p->data = key;
+  p->lchild = p->rchild = NULL;
+  p->count = p->height = p->dup = 1;
+  return p;
+}
+
+static void BSTPoolFree(BSTPool *P) { // 释放池的全部slab，与结点数无关
+  while (P->slabs != NULL) {
+    void *next = ((BSTSlab *)P->slabs)->next;
+    BSTSlabRelease((BSTSlab *)P->slabs);
+    P->slabs = next;
+  }
+  free(P);
+}
+
+static void BSTFreeNode(BSTNode *p) { // 结点放回所属池，树删空时连池一起释放
+  BSTPool *P = BSTPoolOf(p);
+  if (P == NULL) {
+    free(p);
+    return;
+  }
+  p->lchild = P->freeList;
+  P->freeList = p;
+  if (--P->live == 0)
+    BSTPoolFree(P);
+}
+
+static int BSTCount(BiTree T) { return T ? T->count : 0; }
+static int BSTHeight(BiTree T) { return T ? T->height : 0; }
+
+static void BSTPull(BiTree T) { // 由孩子重新计算count和height
+  T->count = BSTCount(T->lchild) + BSTCount(T->rchild) + T->dup;
+  int hl = BSTHeight(T->lchild), hr = BSTHeight(T->rchild);
+  T->height = (hl > hr ? hl : hr) + 1;
+}
+
+static bool BSTInsertAt(BSTPool **P, BiTree &T, ElemType key) {
   if (T == NULL) {
-    T = (BiTree)malloc(sizeof(BSTNode));
-    T->data = key;
-    T->lchild = T->rchild = NULL;
-    return true;
+    T = BSTNewNode(P, key);
+    return T != NULL;
   } else if (key == T->data)
     return false;
-  else if (key < T->data)
-    return BSTInsert(T->lchild, key);
-  else
-    return BSTInsert(T->rchild, key);
+  bool ok = BSTInsertAt(P, key < T->data ? T->lchild : T->rchild, key);
+  if (ok) // 插入成功时沿途各结点的子树结点数加一
+    BSTPull(T);
+  return ok;
+}
+
+static BSTPool **BSTPoolFor(BiTree T, BSTPool *&P) { // 往T中插入时用的池：空树新建池，手工建立的树返回NULL（逐个malloc）
+  P = T ? BSTPoolOf(T) : NULL;
+  return T == NULL || P != NULL ? &P : NULL;
+}
+
+bool BSTInsert(BiTree &T, ElemType key) { // 二叉排序树插入，结点取自该树的结点池
+  BSTPool *P;
+  return BSTInsertAt(BSTPoolFor(T, P), T, key);
 }
 
 void BSTCreate(BiTree &T, ElemType keyArray[], int n) { // 二叉排序树的构建
   T = NULL;
+  BSTPool *P = NULL; // 所有结点取自同一个新池
   int i = 0;
   while (i < n) {
-    BSTInsert(T, keyArray[i]);
+    BSTInsertAt(&P, T, keyArray[i]);
     i++;
   }
 }
 
+static void BSTFreeTree(BiTree T) { // 后序释放逐个malloc的结点
+  if (T == NULL)
+    return;
+  BSTFreeTree(T->lchild);
+  BSTFreeTree(T->rchild);
+  free(T);
+}
+
+void BSTDestroy(BiTree &T) { // 由结点池建立的树整块释放slab，不必遍历结点
+  if (T == NULL)
+    return;
+  BSTPool *P = BSTPoolOf(T);
+  if (P != NULL)
+    BSTPoolFree(P);
+  else
+    BSTFreeTree(T);
+  T = NULL;
+}
+
+// 顺序统计树：在BSTNode上做AVL平衡
+
+static BiTree BSTRotateRight(BiTree T) { // 右旋，返回新的子树根
+  BiTree L = T->lchild;
+  T->lchild = L->rchild;
+  L->rchild = T;
+  BSTPull(T);
+  BSTPull(L);
+  return L;
+}
+
+static BiTree BSTRotateLeft(BiTree T) { // 左旋
+  BiTree R = T->rchild;
+  T->rchild = R->lchild;
+  R->lchild = T;
+  BSTPull(T);
+  BSTPull(R);
+  return R;
+}
+
+static BiTree BSTRebalance(BiTree T) { // 更新T并恢复平衡，返回新的子树根
+  /**
+   * 插入或删除后左右子树高度差最多为2：
+   * LL/RR型单旋一次；LR/RL型先对孩子反向旋转，再对T旋转。
+   * 旋转只改变两三个结点的孩子，count随之由孩子重新计算，不必整棵子树重算。
+   */
+  BSTPull(T);
+  int bf = BSTHeight(T->lchild) - BSTHeight(T->rchild);
+  if (bf > 1) {
+    if (BSTHeight(T->lchild->lchild) < BSTHeight(T->lchild->rchild))
+      T->lchild = BSTRotateLeft(T->lchild);
+    return BSTRotateRight(T);
+  }
+  if (bf < -1) {
+    if (BSTHeight(T->rchild->rchild) < BSTHeight(T->rchild->lchild))
+      T->rchild = BSTRotateRight(T->rchild);
+    return BSTRotateLeft(T);
+  }
+  return T;
+}
+
+static bool OSTInsertAt(BSTPool **P, BiTree &T, ElemType key) {
+  if (T == NULL) {
+    T = BSTNewNode(P, key);
+    return T != NULL;
+  }
+  bool ok = true;
+  if (key == T->data)
+    T->dup++;
+  else
+    ok = OSTInsertAt(P, key < T->data ? T->lchild : T->rchild, key);
+  if (ok)
+    T = BSTRebalance(T);
+  return ok;
+}
+
+bool OSTInsert(BiTree &T, ElemType key) { // 顺序统计树插入
+  /**
+   * BSTInsert有序插入时退化成链表，KthSmall、GetLevel都变成O(n)。
+   * 这里按AVL插入，回溯时逐层更新count、height并旋转，树高不超过1.44log2(n)。
+   * 重复的键不新建结点，只把dup加一。
+   */
+  BSTPool *P;
+  return OSTInsertAt(BSTPoolFor(T, P), T, key);
+}
+
+bool OSTDelete(BiTree &T, ElemType key) { // 顺序统计树删除一个key
+  /**
+   * dup大于1时只减一。否则删除结点：
+   * 至多一个孩子时由孩子顶替；有两个孩子时用右子树的最小结点（后继）顶替，
+   * 再到右子树中把后继整个删掉。回溯时同插入一样逐层更新并旋转。
+   */
+  if (T == NULL)
+    return false;
+  bool ok = true;
+  if (key < T->data)
+    ok = OSTDelete(T->lchild, key);
+  else if (key > T->data)
+    ok = OSTDelete(T->rchild, key);
+  else if (T->dup > 1)
+    T->dup--;
+  else if (T->lchild == NULL || T->rchild == NULL) {
+    BiTree child = T->lchild ? T->lchild : T->rchild;
+    BSTFreeNode(T);
+    T = child;
+    return true;
+  } else {
+    BiTree s = T->rchild;
+    while (s->lchild)
+      s = s->lchild;
+    T->data = s->data;
+    T->dup = s->dup;
+    s->dup = 1; // 让下面的删除把后继结点整个摘掉
+    OSTDelete(T->rchild, s->data);
+  }
+  if (ok)
+    T = BSTRebalance(T);
+  return ok;
+}
+
+int OSTRank(BiTree T, ElemType key) { // 小于key的元素个数，O(树高)
+  int r = 0;
+  while (T != NULL) {
+    if (key <= T->data) {
+      T = T->lchild;
+    } else { // 左子树和T本身都小于key
+      r += BSTCount(T->lchild) + T->dup;
+      T = T->rchild;
+    }
+  }
+  return r;
+}
+
+// B+树
+
+static KeyType *BPKeys(BPNode *x) { return (KeyType *)(x + 1); }
+static const KeyType *BPKeys(const BPNode *x) { return (const KeyType *)(x + 1); }
+static BPNode **BPChild(const BPTree &T, BPNode *x) { // 孩子指针数组，只对内部结点有意义
+  return (BPNode **)((char *)(x + 1) + T.keyBytes);
+}
+static BPNode *const *BPChild(const BPTree &T, const BPNode *x) {
+  return (BPNode *const *)((const char *)(x + 1) + T.keyBytes);
+}
+
+static int BPCountLess(const KeyType k[], int n, KeyType key) { // 小于key的键数
+  int i = 0;
+  for (int j = 0; j < n; j++) // 无分支计数，编译器可向量化；结点只有几十个键，比二分更快
+    i += k[j] < key;
+  return i;
+}
+
+static int BPCountLessEqual(const KeyType k[], int n, KeyType key) { // 不大于key的键数，即应下降的孩子
+  int i = 0;
+  for (int j = 0; j < n; j++)
+    i += k[j] <= key;
+  return i;
+}
+
+static bool BPNewSlab(BPTree &T) { // 再分配一块slab
+  /**
+   * 结点大小按64字节取整，slab按64字节对齐，每个结点都从缓存行开头开始。
+   * 一块slab的开头64字节存放链表指针，Destroy时只需逐块释放，不用遍历整棵树。
+   */
+  char *slab = (char *)aligned_alloc(64, 64 + BPTREE_SLAB_NODES * T.nodeBytes);
+  if (slab == NULL)
+    return false;
+  *(void **)slab = T.slabs;
+  T.slabs = slab;
+  T.cursor = slab + 64;
+  T.limit = T.cursor + BPTREE_SLAB_NODES * T.nodeBytes;
+  return true;
+}
+
+static bool BPReserve(BPTree &T, int need) { // 保证空闲链表中至少有need个结点
+  /**
+   * 插入最多分裂height+1个结点。先把所需结点备齐，分裂过程中就不会因内存不足半途失败。
+   */
+  int have = 0;
+  for (BPNode *x = T.freeList; x != NULL && have < need; x = x->next)
+    have++;
+  for (; have < need; have++) {
+    if (T.cursor == T.limit && !BPNewSlab(T))
+      return false;
+    BPNode *x = (BPNode *)T.cursor;
+    T.cursor += T.nodeBytes;
+    x->next = T.freeList;
+    T.freeList = x;
+  }
+  return true;
+}
+
+static BPNode *BPNewNode(BPTree &T, bool leaf) { // 调用前须已BPReserve
+  BPNode *x = T.freeList;
+  T.freeList = x->next;
+  x->n = 0;
+  x->leaf = leaf;
+  x->prev = x->next = NULL;
+  return x;
+}
+
+static void BPFreeNode(BPTree &T, BPNode *x) {
+  x->next = T.freeList;
+  T.freeList = x;
+}
+
+bool BPTreeInit(BPTree &T, int order) { // 初始化为只有一个空叶子的树
+  /**
+   * 每个结点多留一个键和一个孩子的位置：插入时先放进去，超过order再分裂，
+   * 分裂和借键的代码就不必处理“放不下”的中间状态。
+   */
+  if (order < 3)
+    return false;
+  T.order = order;
+  T.keyBytes = ((order + 1) * sizeof(KeyType) + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+  T.nodeBytes = (sizeof(BPNode) + T.keyBytes + (order + 2) * sizeof(BPNode *) + 63) / 64 * 64;
+  T.slabs = NULL;
+  T.freeList = NULL;
+  T.cursor = T.limit = NULL;
+  T.size = 0;
+  T.height = 1;
+  if (!BPReserve(T, 1))
+    return false;
+  T.root = T.head = T.tail = BPNewNode(T, true);
+  return true;
+}
+
+static const BPNode *BPFindLeaf(const BPTree &T, KeyType key) { // key所在（或应插入）的叶子
+  const BPNode *x = T.root;
+  while (!x->leaf)
+    x = BPChild(T, x)[BPCountLessEqual(BPKeys(x), x->n, key)];
+  return x;
+}
+
+bool BPTreeSearch(const BPTree &T, KeyType key) {
+  const BPNode *x = BPFindLeaf(T, key);
+  int i = BPCountLess(BPKeys(x), x->n, key);
+  return i < x->n && BPKeys(x)[i] == key;
+}
+
+bool BPTreeInsert(BPTree &T, KeyType key) { // B+树插入
+  /**
+   * 1. 从根走到叶子，记下路径；叶子中已有key则返回false
+   * 2. 插入叶子，键数超过order时对半分裂，右半的第一个键复制一份作为分隔键插入父结点
+   * 3. 父结点超过order时也对半分裂，中间的键上移（内部结点的分隔键不保留在孩子中）
+   * 4. 根分裂时新建根，树高加一，所有叶子始终在同一层
+   */
+  BPNode *path[64];
+  int idx[64], h = 0;
+  BPNode *x = T.root;
+  while (!x->leaf) {
+    int i = BPCountLessEqual(BPKeys(x), x->n, key);
+    path[h] = x;
+    idx[h++] = i;
+    x = BPChild(T, x)[i];
+  }
+  KeyType *k = BPKeys(x);
+  int pos = BPCountLess(k, x->n, key);
+  if (pos < x->n && k[pos] == key)
+    return false;
+  if (x->n == T.order && !BPReserve(T, T.height + 1)) // 满了才可能分裂
+    return false;
+  memmove(k + pos + 1, k + pos, (x->n - pos) * sizeof(KeyType));
+  k[pos] = key;
+  x->n++;
+  T.size++;
+  if (x->n <= T.order)
+    return true;
+
+  BPNode *right = BPNewNode(T, true); // 叶子分裂
+  int mid = x->n / 2;
+  right->n = x->n - mid;
+  memcpy(BPKeys(right), k + mid, right->n * sizeof(KeyType));
+  x->n = mid;
+  right->prev = x;
+  right->next = x->next;
+  if (x->next)
+    x->next->prev = right;
+  else
+    T.tail = right;
+  x->next = right;
+  KeyType sep = BPKeys(right)[0];
+
+  while (h > 0) { // 分隔键和新结点插入父结点，必要时继续向上分裂
+    BPNode *p = path[--h];
+    int i = idx[h];
+    KeyType *pk = BPKeys(p);
+    BPNode **pc = BPChild(T, p);
+    memmove(pk + i + 1, pk + i, (p->n - i) * sizeof(KeyType));
+    memmove(pc + i + 2, pc + i + 1, (p->n - i) * sizeof(BPNode *));
+    pk[i] = sep;
+    pc[i + 1] = right;
+    p->n++;
+    if (p->n <= T.order)
+      return true;
+    right = BPNewNode(T, false);
+    mid = p->n / 2;
+    sep = pk[mid];
+    right->n = p->n - mid - 1;
+    memcpy(BPKeys(right), pk + mid + 1, right->n * sizeof(KeyType));
+    memcpy(BPChild(T, right), pc + mid + 1, (right->n + 1) * sizeof(BPNode *));
+    p->n = mid;
+    x = p;
+  }
+  BPNode *root = BPNewNode(T, false); // 根分裂
+  BPKeys(root)[0] = sep;
+  BPChild(T, root)[0] = x;
+  BPChild(T, root)[1] = right;
+  root->n = 1;
+  T.root = root;
+  T.height++;
+  return true;
+}
+
+static void BPMerge(BPTree &T, BPNode *p, int s) { // 把p的第s+1个孩子并入第s个孩子，删去分隔键s
+  BPNode *l = BPChild(T, p)[s], *r = BPChild(T, p)[s + 1];
+  if (l->leaf) {
+    memcpy(BPKeys(l) + l->n, BPKeys(r), r->n * sizeof(KeyType));
+    l->n += r->n;
+    l->next = r->next;
+    if (r->next)
+      r->next->prev = l;
+    else
+      T.tail = l;
+  } else { // 内部结点合并时，父结点的分隔键下移到中间
+    BPKeys(l)[l->n] = BPKeys(p)[s];
+    memcpy(BPKeys(l) + l->n + 1, BPKeys(r), r->n * sizeof(KeyType));
+    memcpy(BPChild(T, l) + l->n + 1, BPChild(T, r), (r->n + 1) * sizeof(BPNode *));
+    l->n += r->n + 1;
+  }
+  BPFreeNode(T, r);
+  memmove(BPKeys(p) + s, BPKeys(p) + s + 1, (p->n - s - 1) * sizeof(KeyType));
+  memmove(BPChild(T, p) + s + 1, BPChild(T, p) + s + 2, (p->n - s - 1) * sizeof(BPNode *));
+  p->n--;
+}
+
+static void BPBorrowLeft(BPTree &T, BPNode *p, int i) { // p的第i个孩子从左兄弟借一个键
+  BPNode *x = BPChild(T, p)[i], *l = BPChild(T, p)[i - 1];
+  KeyType *xk = BPKeys(x), *lk = BPKeys(l);
+  memmove(xk + 1, xk, x->n * sizeof(KeyType));
+  if (x->leaf) {
+    xk[0] = lk[l->n - 1];
+    BPKeys(p)[i - 1] = xk[0];
+  } else { // 内部结点借键要经过父结点旋转，孩子指针跟着移动
+    BPNode **xc = BPChild(T, x);
+    memmove(xc + 1, xc, (x->n + 1) * sizeof(BPNode *));
+    xk[0] = BPKeys(p)[i - 1];
+    xc[0] = BPChild(T, l)[l->n];
+    BPKeys(p)[i - 1] = lk[l->n - 1];
+  }
+  x->n++;
+  l->n--;
+}
+
+static void BPBorrowRight(BPTree &T, BPNode *p, int i) { // p的第i个孩子从右兄弟借一个键
+  BPNode *x = BPChild(T, p)[i], *r = BPChild(T, p)[i + 1];
+  KeyType *xk = BPKeys(x), *rk = BPKeys(r);
+  if (x->leaf) {
+    xk[x->n] = rk[0];
+    memmove(rk, rk + 1, (r->n - 1) * sizeof(KeyType));
+    BPKeys(p)[i] = rk[0];
+  } else {
+    BPNode **rc = BPChild(T, r);
+    xk[x->n] = BPKeys(p)[i];
+    BPChild(T, x)[x->n + 1] = rc[0];
+    BPKeys(p)[i] = rk[0];
+    memmove(rk, rk + 1, (r->n - 1) * sizeof(KeyType));
+    memmove(rc, rc + 1, r->n * sizeof(BPNode *));
+  }
+  x->n++;
+  r->n--;
+}
+
+bool BPTreeDelete(BPTree &T, KeyType key) { // B+树删除
+  /**
+   * 1. 从叶子中删去key。内部结点中等于key的分隔键可以保留，它仍能正确划分左右子树
+   * 2. 结点键数少于order/2时，先向键数富余的左/右兄弟借一个键，
+   *    兄弟都不富余则与兄弟合并，父结点少一个键，再检查父结点
+   * 3. 根变成没有键的内部结点时，它唯一的孩子成为新根，树高减一
+   */
+  BPNode *path[64];
+  int idx[64], h = 0;
+  BPNode *x = T.root;
+  while (!x->leaf) {
+    int i = BPCountLessEqual(BPKeys(x), x->n, key);
+    path[h] = x;
+    idx[h++] = i;
+    x = BPChild(T, x)[i];
+  }
+  KeyType *k = BPKeys(x);
+  int pos = BPCountLess(k, x->n, key);
+  if (pos == x->n || k[pos] != key)
+    return false;
+  memmove(k + pos, k + pos + 1, (x->n - pos - 1) * sizeof(KeyType));
+  x->n--;
+  T.size--;
+
+  int minKeys = T.order / 2;
+  while (h > 0 && x->n < minKeys) {
+    BPNode *p = path[--h];
+    int i = idx[h];
+    if (i > 0 && BPChild(T, p)[i - 1]->n > minKeys) {
+      BPBorrowLeft(T, p, i);
+      return true;
+    }
+    if (i < p->n && BPChild(T, p)[i + 1]->n > minKeys) {
+      BPBorrowRight(T, p, i);
+      return true;
+    }
+    BPMerge(T, p, i > 0 ? i - 1 : i);
+    x = p;
+  }
+  if (!T.root->leaf && T.root->n == 0) {
+    BPNode *old = T.root;
+    T.root = BPChild(T, old)[0];
+    BPFreeNode(T, old);
+    T.height--;
+  }
+  return true;
+}
+
+bool BPTreeBulkLoad(BPTree &T, const KeyType keys[], int n) { // 由有序序列自底向上建树
+  /**
+   * 逐个插入每次都要从根走到叶子，且分裂后的结点只有半满。
+   * 有序输入可以直接按层构建：
+   * 1. 去重后把键平均分到ceil(m/order)个叶子中，依次链接
+   * 2. 每层把结点平均分给ceil(结点数/(order+1))个父结点，
+   *    父结点的分隔键取各孩子（第二个起）子树中的最小键，直到只剩一个结点
+   * 平均分配保证每个结点都不少于order/2个键。结点几乎全满，空间利用率接近100%。
+   */
+  for (int i = 1; i < n; i++)
+    if (keys[i] < keys[i - 1])
+      return false;
+  int order = T.order;
+  BPTreeDestroy(T);
+  if (!BPTreeInit(T, order))
+    return false;
+  int m = 0; // 去重后的键数
+  for (int i = 0; i < n; i++)
+    if (i == 0 || keys[i] != keys[i - 1])
+      m++;
+  if (m == 0)
+    return true;
+
+  int cnt = (m + order - 1) / order; // 当前层结点数
+  std::vector<BPNode *> level(cnt), up;
+  std::vector<KeyType> low(cnt), upLow; // 各结点子树中的最小键
+  BPFreeNode(T, T.root);
+  int need = 0;
+  for (long long c = cnt; c > 1; c = (c + order) / (order + 1))
+    need += (int)c;
+  if (!BPReserve(T, need + 1)) {
+    BPTreeDestroy(T);
+    BPTreeInit(T, order);
+    return false;
+  }
+  for (int j = 0, i = 0; j < cnt; j++) {
+    BPNode *x = BPNewNode(T, true);
+    int take = m / cnt + (j < m % cnt);
+    while (x->n < take) {
+      if (i == 0 || keys[i] != keys[i - 1])
+        BPKeys(x)[x->n++] = keys[i];
+      i++;
+    }
+    low[j] = BPKeys(x)[0];
+    x->prev = j > 0 ? level[j - 1] : NULL;
+    if (j > 0)
+      level[j - 1]->next = x;
+    level[j] = x;
+  }
+  T.head = level[0];
+  T.tail = level[cnt - 1];
+  T.size = m;
+  T.height = 1;
+  while (cnt > 1) {
+    int pcnt = (cnt + order) / (order + 1);
+    up.resize(pcnt);
+    upLow.resize(pcnt);
+    for (int j = 0, c = 0; j < pcnt; j++) {
+      BPNode *p = BPNewNode(T, false);
+      int take = cnt / pcnt + (j < cnt % pcnt); // 孩子数
+      upLow[j] = low[c];
+      for (int t = 0; t < take; t++, c++) {
+        BPChild(T, p)[t] = level[c];
+        if (t > 0)
+          BPKeys(p)[t - 1] = low[c];
+      }
+      p->n = take - 1;
+      up[j] = p;
+    }
+    level.swap(up);
+    low.swap(upLow);
+    cnt = pcnt;
+    T.height++;
+  }
+  T.root = level[0];
+  return true;
+}
+
+BPTreeIter BPTreeLowerBound(const BPTree &T, KeyType key) {
+  BPTreeIter it;
+  it.leaf = BPFindLeaf(T, key);
+  it.pos = BPCountLess(BPKeys(it.leaf), it.leaf->n, key);
+  return it;
+}
+
+bool BPTreeNext(BPTreeIter &it, KeyType &key) { // 叶子之间沿链表前进，不回到上层
+  while (it.leaf != NULL && it.pos >= it.leaf->n) {
+    it.leaf = it.leaf->next;
+    it.pos = 0;
+  }
+  if (it.leaf == NULL)
+    return false;
+  key = BPKeys(it.leaf)[it.pos++];
+  return true;
+}
+
+void BPTreePrintBigger(const BPTree &T, KeyType k) { // 从最右叶子沿prev逆序扫描，遇到<k的键即停止
+  for (const BPNode *x = T.tail; x != NULL; x = x->prev) {
+    for (int i = x->n - 1; i >= 0; i--) {
+      if (BPKeys(x)[i] < k)
+        return;
+      printf("%d ", BPKeys(x)[i]);
+    }
+  }
+}
+
+static bool BPCheck(const BPTree &T, const BPNode *x, int depth, bool hasLo,
+                    KeyType lo, bool hasHi, KeyType hi,
+                    const BPNode *&prevLeaf, int &count) { // 递归检查以x为根的子树，键都在[lo, hi)内
+  const KeyType *k = BPKeys(x);
+  if (x != T.root && x->n < T.order / 2)
+    return false;
+  if (x->n > T.order)
+    return false;
+  for (int i = 0; i < x->n; i++) {
+    if ((i > 0 && k[i - 1] >= k[i]) || (hasLo && k[i] < lo) || (hasHi && k[i] >= hi))
+      return false;
+  }
+  if (x->leaf) { // 叶子都在同一层，且链表顺序与中序一致
+    if (depth != T.height || x->prev != prevLeaf || (prevLeaf == NULL && x != T.head))
+      return false;
+    if (prevLeaf != NULL && prevLeaf->next != x)
+      return false;
+    prevLeaf = x;
+    count += x->n;
+    return true;
+  }
+  for (int i = 0; i <= x->n; i++) {
+    if (!BPCheck(T, BPChild(T, x)[i], depth + 1, i > 0 || hasLo, i > 0 ? k[i - 1] : lo,
+                 i < x->n || hasHi, i < x->n ? k[i] : hi, prevLeaf, count))
+      return false;
+  }
+  return true;
+}
+
+bool BPTreeIsValid(const BPTree &T) { // 检查B+树的全部性质
+  const BPNode *prevLeaf = NULL;
+  int count = 0;
+  if (!BPCheck(T, T.root, 1, false, 0, false, 0, prevLeaf, count))
+    return false;
+  return prevLeaf == T.tail && T.tail->next == NULL && count == T.size;
+}
+
+void BPTreeDestroy(BPTree &T) {
+  while (T.slabs != NULL) {
+    void *next = *(void **)T.slabs;
+    free(T.slabs);
+    T.slabs = next;
+  }
+  T.root = T.head = T.tail = NULL;
+  T.freeList = NULL;
+  T.cursor = T.limit = NULL;
+  T.size = 0;
+  T.height = 0;
+}
+
+// 散列表
+
+static const signed char HASH_EMPTY = -128;
+static const int HASH_MIGRATE_GROUPS = 2; // 扩容期间每次插入/删除至少迁移的旧表组数
+static const int HASH_BATCH = 16;         // FindMany每批预取的键数
+
+static unsigned long long HashKey(KeyType key) { // 64位混合（murmur3 finalizer），高位定组，低7位存入控制字节
+  unsigned long long h = (unsigned int)key;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+static int HashHome(const HashArray &A, unsigned long long h) { // 探测起始组
+  return (int)((h >> 7) & (A.groups - 1));
+}
+
+static unsigned HashMatch(const signed char *ctrl, signed char c) { // 组内控制字节等于c的位置，按位返回
+#if defined(SEARCH_HAVE_AVX2) && defined(__SSE2__)
+  __m128i g = _mm_load_si128((const __m128i *)ctrl);
+  return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(c)));
+#else
+  unsigned m = 0;
+  for (int i = 0; i < HASH_GROUP; i++)
+    m |= (unsigned)(ctrl[i] == c) << i;
+  return m;
+#endif
+}
+
+static bool HashArrayAlloc(HashArray &A, int groups) { // 控制字节按16字节对齐以便整组装入
+  A.groups = groups;
+  A.size = 0;
+  size_t ctrlBytes = ((size_t)groups * HASH_GROUP + 63) / 64 * 64; // aligned_alloc要求大小是对齐的倍数
+  A.ctrl = (signed char *)aligned_alloc(64, ctrlBytes);
+  A.slots = (HashSlot *)aligned_alloc(64, (size_t)groups * HASH_GROUP * sizeof(HashSlot));
+  if (A.ctrl == NULL || A.slots == NULL) {
+    free(A.ctrl);
+    free(A.slots);
+    A.ctrl = NULL;
+    A.slots = NULL;
+    return false;
+  }
+  memset(A.ctrl, HASH_EMPTY, (size_t)groups * HASH_GROUP);
+  return true;
+}
+
+static void HashArrayFree(HashArray &A) {
+  free(A.ctrl);
+  free(A.slots);
+  A.ctrl = NULL;
+  A.slots = NULL;
+  A.groups = A.size = 0;
+}
+
+static int HashProbe(const HashArray &A, KeyType key, unsigned long long h,
+                     int *insertAt) { // 返回key所在的槽，不存在返回-1；insertAt为应插入的空槽
+  /**
+   * 从起始组开始逐组探测：
+   * 1. 一次比较16个控制字节，只有低7位相同的槽才去比较键，误比较的概率约为1/128
+   * 2. 组内有空槽就可以停止：插入总是放进探测路上第一个有空槽的组，
+   *    所以key若存在，不会越过一个有空槽的组（删除时也维持这一点，见HashErase）
+   */
+  signed char h2 = (signed char)(h & 0x7f);
+  for (int g = HashHome(A, h);; g = (g + 1) & (A.groups - 1)) {
+    const signed char *ctrl = A.ctrl + g * HASH_GROUP;
+    for (unsigned m = HashMatch(ctrl, h2); m != 0; m &= m - 1) {
+      int i = g * HASH_GROUP + __builtin_ctz(m);
+      if (A.slots[i].key == key)
+        return i;
+    }
+    unsigned empty = HashMatch(ctrl, HASH_EMPTY);
+    if (empty != 0) {
+      if (insertAt != NULL)
+        *insertAt = g * HASH_GROUP + __builtin_ctz(empty);
+      return -1;
+    }
+  }
+}
+
+static void HashPlace(HashArray &A, int i, KeyType key, ElemType value,
+                      unsigned long long h) {
+  A.ctrl[i] = (signed char)(h & 0x7f);
+  A.slots[i].key = key;
+  A.slots[i].value = value;
+  A.size++;
+}
+
+static void HashErase(HashArray &A, int hole) { // 删除槽hole，不留墓碑
+  /**
+   * 直接置空会让后面的键“断路”：它们的探测经过hole所在的组时会提前停下。
+   * 组hole原来就有空槽时不会有键越过它，直接置空即可；
+   * 否则往后逐组寻找起始组不在(hole组, 当前组]内的键，说明它的探测经过了hole组，
+   * 把它搬进hole，它原来的位置成为新的hole，继续处理，直到扫过一个原本就有空槽的组。
+   * 这是线性探测的后移删除，只是以组为单位。
+   */
+  int mask = A.groups - 1, g = hole / HASH_GROUP;
+  bool hadEmpty = HashMatch(A.ctrl + g * HASH_GROUP, HASH_EMPTY) != 0;
+  A.ctrl[hole] = HASH_EMPTY;
+  A.size--;
+  if (hadEmpty)
+    return;
+  for (int j = (g + 1) & mask;; j = (j + 1) & mask) {
+    const signed char *ctrl = A.ctrl + j * HASH_GROUP;
+    bool end = HashMatch(ctrl, HASH_EMPTY) != 0;
+    unsigned full = ~HashMatch(ctrl, HASH_EMPTY) & ((1u << HASH_GROUP) - 1);
+    for (; full != 0; full &= full - 1) {
+      int t = j * HASH_GROUP + __builtin_ctz(full);
+      int home = HashHome(A, HashKey(A.slots[t].key));
+      int dh = (home - g) & mask, dj = (j - g) & mask;
+      if (dh == 0 || dh > dj) { // 起始组不在(g, j]内
+        A.ctrl[hole] = A.ctrl[t];
+        A.slots[hole] = A.slots[t];
+        A.ctrl[t] = HASH_EMPTY;
+        hole = t;
+        g = j;
+        break;
+      }
+    }
+    if (end)
+      return;
+  }
+}
+
+static void HashMigrate(HashTable &H, int groups) { // 从旧表迁移至少groups组到新表
+  /**
+   * 一次迁移完整的探测链（连续的满组加上结尾一个有空槽的组）才停下，
+   * 已迁移的组全部置空，剩下的键起始组都在未迁移的部分，旧表上的查找和删除仍然正确。
+   */
+  while (H.old.ctrl != NULL) {
+    int g = H.migrateNext;
+    signed char *ctrl = H.old.ctrl + g * HASH_GROUP;
+    bool chainEnd = HashMatch(ctrl, HASH_EMPTY) != 0;
+    unsigned full = ~HashMatch(ctrl, HASH_EMPTY) & ((1u << HASH_GROUP) - 1);
+    for (; full != 0; full &= full - 1) {
+      HashSlot &s = H.old.slots[g * HASH_GROUP + __builtin_ctz(full)];
+      unsigned long long h = HashKey(s.key);
+      int at = -1;
+      HashProbe(H.cur, s.key, h, &at); // 键只会在一张表中，不必检查重复
+      HashPlace(H.cur, at, s.key, s.value, h);
+      H.old.size--;
+    }
+    memset(ctrl, HASH_EMPTY, HASH_GROUP);
+    H.migrateNext = (g + 1) & (H.old.groups - 1);
+    if (--H.migrateLeft == 0) {
+      HashArrayFree(H.old);
+      return;
+    }
+    if (--groups <= 0 && chainEnd)
+      return;
+  }
+}
+
+static bool HashGrow(HashTable &H) { // 开始扩容：分配两倍大的新表，旧表留待逐步迁移
+  HashArray next;
+  if (!HashArrayAlloc(next, H.cur.groups * 2))
+    return false;
+  H.old = H.cur;
+  H.cur = next;
+  /**
+   * 从一条探测链的开头开始迁移：找一个前一组有空槽的组。
+   * 迁移所需的插入次数约为 旧组数/HASH_MIGRATE_GROUPS，远在新表达到装填上限之前就能完成。
+   */
+  int g = 0, mask = H.old.groups - 1;
+  while (HashMatch(H.old.ctrl + ((g - 1) & mask) * HASH_GROUP, HASH_EMPTY) == 0)
+    g++;
+  H.migrateNext = g;
+  H.migrateLeft = H.old.groups;
+  return true;
+}
+
+bool HashInit(HashTable &H, int capacity, double maxLoad) { // 初始化散列表
+  /**
+   * 教材中的散列表用链地址法或线性探测，每次探测都要访问一个槽再比较一次。
+   * 这里沿用开放定址，但每16个槽配一组控制字节：
+   * 1. 控制字节存放哈希值的低7位，一次SSE2比较就能筛出整组中可能相等的槽
+   * 2. 删除时把后面的键往前搬，不留墓碑，长时间增删后探测长度也不会变长
+   * 3. 超过装填上限时分配两倍的新表，之后每次插入/删除顺带迁移几组，不会有一次插入搬动整张表
+   */
+  if (maxLoad <= 0 || maxLoad > 15.0 / 16)
+    maxLoad = HASH_MAX_LOAD;
+  int groups = 1;
+  while (groups * HASH_GROUP * maxLoad < capacity)
+    groups *= 2;
+  H.maxLoad = maxLoad;
+  H.size = 0;
+  H.old.ctrl = NULL;
+  H.old.slots = NULL;
+  H.old.groups = H.old.size = 0;
+  H.migrateNext = H.migrateLeft = 0;
+  return HashArrayAlloc(H.cur, groups);
+}
+
+bool HashFind(const HashTable &H, KeyType key, ElemType *value) {
+  unsigned long long h = HashKey(key);
+  int i = HashProbe(H.cur, key, h, NULL);
+  if (i >= 0) {
+    if (value)
+      *value = H.cur.slots[i].value;
+    return true;
+  }
+  if (H.old.ctrl != NULL && (i = HashProbe(H.old, key, h, NULL)) >= 0) {
+    if (value)
+      *value = H.old.slots[i].value;
+    return true;
+  }
+  return false;
+}
+
+bool HashInsert(HashTable &H, KeyType key, ElemType value) { // 插入或更新
+  unsigned long long h = HashKey(key);
+  int i, at = -1;
+  if (H.old.ctrl != NULL && (i = HashProbe(H.old, key, h, NULL)) >= 0) {
+    H.old.slots[i].value = value; // 还在旧表中的键原地更新
+    HashMigrate(H, HASH_MIGRATE_GROUPS);
+    return false;
+  }
+  if ((i = HashProbe(H.cur, key, h, &at)) >= 0) {
+    H.cur.slots[i].value = value;
+    return false;
+  }
+  long long cap = (long long)H.cur.groups * HASH_GROUP;
+  if (H.old.ctrl == NULL && H.cur.size + 1 > H.maxLoad * cap) {
+    if (HashGrow(H))
+      HashProbe(H.cur, key, h, &at); // 换了新表，重新定位空槽
+    else if (H.cur.size + 1 >= cap) // 扩容失败时最多用到只剩一个空槽
+      return false;
+  }
+  HashPlace(H.cur, at, key, value, h);
+  H.size++;
+  if (H.old.ctrl != NULL)
+    HashMigrate(H, HASH_MIGRATE_GROUPS);
+  return true;
+}
+
+bool HashDelete(HashTable &H, KeyType key) {
+  unsigned long long h = HashKey(key);
+  int i = HashProbe(H.cur, key, h, NULL);
+  if (i >= 0) {
+    HashErase(H.cur, i);
+  } else if (H.old.ctrl != NULL && (i = HashProbe(H.old, key, h, NULL)) >= 0) {
+    HashErase(H.old, i);
+  } else {
+    return false;
+  }
+  H.size--;
+  if (H.old.ctrl != NULL)
+    HashMigrate(H, HASH_MIGRATE_GROUPS);
+  return true;
+}
+
+void HashFindMany(const HashTable &H, const KeyType keys[], int n, bool found[],
+                  ElemType values[]) { // 成批查找
+  /**
+   * 逐个查找时，每个键都要等起始组的控制字节和槽从内存取回才能继续。
+   * 这里每批先算出HASH_BATCH个键的哈希值并预取它们的起始组，再依次探测，
+   * 这些缺失互相重叠，表远大于缓存时吞吐量明显提高。
+   */
+  unsigned long long h[HASH_BATCH];
+  for (int base = 0; base < n; base += HASH_BATCH) {
+    int m = n - base < HASH_BATCH ? n - base : HASH_BATCH;
+    for (int k = 0; k < m; k++) {
+      h[k] = HashKey(keys[base + k]);
+      int g = HashHome(H.cur, h[k]);
+      __builtin_prefetch(H.cur.ctrl + g * HASH_GROUP);
+      __builtin_prefetch(H.cur.slots + g * HASH_GROUP); // 一组槽占两个缓存行，探测多从组内前几个槽命中
+      if (H.old.ctrl != NULL) {
+        g = HashHome(H.old, h[k]);
+        __builtin_prefetch(H.old.ctrl + g * HASH_GROUP);
+      }
+    }
+    for (int k = 0; k < m; k++) {
+      const HashArray *A = &H.cur;
+      int i = HashProbe(H.cur, keys[base + k], h[k], NULL);
+      if (i < 0 && H.old.ctrl != NULL) {
+        A = &H.old;
+        i = HashProbe(H.old, keys[base + k], h[k], NULL);
+      }
+      found[base + k] = i >= 0;
+      if (values != NULL && i >= 0)
+        values[base + k] = A->slots[i].value;
+    }
+  }
+}
+
+void HashDestroy(HashTable &H) {
+  HashArrayFree(H.cur);
+  HashArrayFree(H.old);
+  H.size = 0;
+}
+
 // 7.2 作业答案
 
 int BinarySearchRecursion(SSTable ST, ElemType key, int low,
@@ -114,17 +1356,15 @@ bool IsBST(BiTree T) { // 6. 判断一棵二叉树是否为BST
 
 int GetLevel(BiTree T, ElemType e) { // 7. 查找结点在BST中的层级
   /**
-   * 每比较一次就层级+1
+   * 每比较一次就层级+1，不存在时返回0
+   * 循环实现，平衡树上最多比较树高次
    */
-  if (!T)
-    return 0; // 如果要更严谨点对于不存在BST中的结点返回-1的话，则需要每次递归判断返回值或增加成功标记
-  if (T->data == e) {
-    return 1;
-  } else if (T->data > e) { // 大了，去左子树中找
-    return 1 + GetLevel(T->lchild, e);
-  } else { // 否则去右子树中找
-    return 1 + GetLevel(T->rchild, e);
+  for (int level = 1; T != NULL; level++) {
+    if (T->data == e)
+      return level;
+    T = T->data > e ? T->lchild : T->rchild; // 大了去左子树，否则去右子树
   }
+  return 0;
 }
 
 void GetMinMax(BiTree T, ElemType &min,
@@ -158,29 +1398,26 @@ void PrintBigger(BiTree T, ElemType k) { // 10. 从大到小输出BST中大于
 
 BSTNode *KthSmall(BiTree T, int k) { // 11. 在BST上查询第k小的元素，
   /**
-   * 本题每个结点新增count元素，记录以该结点为根的子树有多少结点。
-   * 显然根结点是第m小元素，若其左子树结点即m-1>k，则第k小在左子树中，否则在右子树中
-   * 如果在左子树中，则我们去左子树继续寻找第k小。
-   * 如果在右子树中，则我们去右子树寻找第k-m小。
+   * 本题每个结点新增count元素，记录以该结点为根的子树有多少结点（重复的键按dup计）。
+   * 设左子树有m个元素，则根占第m+1..m+dup小。
+   * 若k<=m，则第k小在左子树中，去左子树继续寻找第k小。
+   * 若k>m+dup，则在右子树中，去右子树寻找第k-m-dup小。
+   * 循环实现，只走一条从根向下的路径。
    */
-  if (k < 1 || k > T->count)
+  if (T == NULL || k < 1 || k > T->count)
     return NULL; // 特判出界
-  if (T->lchild ==
-      NULL) { // 左子树不存在，则无法计算m，此时直接是根结点或去右子树找
-    if (k == 1)
+  while (T != NULL) {
+    int m = BSTCount(T->lchild);
+    if (k <= m) {
+      T = T->lchild;
+    } else if (k <= m + T->dup) {
       return T;
-    else
-      return KthSmall(T->rchild, k - 1);
-  } else {
-    if (T->lchild->count == k - 1)
-      return T; // 左子树结点有k-1个，则根就是第k个
-    else if (T->lchild->count >
-             k - 1) { // 左子树结点大于k-1，则去左子树中继续找
-      return KthSmall(T->lchild, k);
-    } else { // 否则去右子树中找第k-m个，m=左子树结点+1
-      return KthSmall(T->rchild, k - (T->lchild->count + 1));
+    } else {
+      k -= m + T->dup;
+      T = T->rchild;
     }
   }
+  return NULL;
 }
 
 // int main() {
@@ -8,14 +8,93 @@ typedef struct {  // 顺序查找表
   int TableLen;   // 表长
 } SSTable;
 
+#define STREE_B 16          // S-tree每个结点的键数，16个int正好一个缓存行
+#define STREE_MAX_HEIGHT 10 // 10层可容纳远超int范围的元素
+
+typedef struct {  // 静态B+树（S-tree），由有序表一次构建，只读
+  ElemType *keys; // 所有结点连续存放，叶子层在前、根在最后，每个结点STREE_B个键，按64字节对齐
+  long long offset[STREE_MAX_HEIGHT]; // 第h层（0为叶子层）第一个键在keys中的下标
+  int height;
+  int n;
+} STree;
+
+typedef struct { // S-tree上的区间遍历
+  const STree *T;
+  int pos, end;  // 下一个要输出的下标，及区间末尾的下一个位置
+} STreeIter;
+
 typedef struct BSTNode {           // 链式存储的BST
   ElemType data;                   // 数据域
   struct BSTNode *lchild, *rchild; // 左右孩子指针
-  int count;                       // 记录子树结点数（7.3 11题用）
+  int count;                       // 子树中的元素个数，重复的键按dup计（7.3 11题用）
+  int height;                      // 子树高度，叶子为1（平衡用）
+  int dup;                         // 该键出现的次数，BSTInsert建的树恒为1
 } BSTNode, *BiTree;
 
+// BSTInsert/BSTCreate/OSTInsert从空树开始建立的树，结点取自该树独占的结点池，
+// 每棵非空树至少占用一块slab；手工malloc建立的树仍可插入，新结点逐个malloc。
+// 线程：不同的树可以在不同线程中同时增删和销毁（只有申请、释放slab时加锁），
+// 同一棵树的修改须由调用者互斥
+#define BST_SLAB_BYTES 16384 // BST结点池每块slab的字节数，也是slab的对齐，须为2的幂
+
 typedef int KeyType;
 
+#define BPTREE_ORDER 32      // B+树默认每个结点最多的键数
+#define BPTREE_SLAB_NODES 64 // 每块slab容纳的结点数
+
+typedef struct BPNode {        // B+树结点，键和孩子指针紧跟在结点头之后，容量由所属树的order决定
+  int n;                       // 键数
+  bool leaf;
+  struct BPNode *prev, *next;  // 叶子层按键序双向链接；回收后next用作空闲链表
+} BPNode;
+
+typedef struct {     // 动态B+树（键集合），结点从slab中分配
+  BPNode *root;
+  BPNode *head, *tail; // 最左、最右叶子
+  int order;           // 每个结点最多order个键，非根结点至少order/2个
+  int height;          // 根为叶子时为1
+  int size;            // 键数
+  size_t keyBytes, nodeBytes;
+  void *slabs;         // slab链表，每块开头存放下一块的地址
+  BPNode *freeList;    // 回收的结点
+  char *cursor, *limit; // 当前slab中未分配部分
+} BPTree;
+
+#define HASH_GROUP 16          // 一组控制字节的个数，一次SSE2比较
+#define HASH_MAX_LOAD 0.875    // 默认最大装填因子
+
+typedef struct {
+  KeyType key;
+  ElemType value;
+} HashSlot;
+
+typedef struct {       // 一张开放定址表
+  signed char *ctrl;   // 每个槽一个控制字节：-128为空，0..127为键的哈希值的低7位
+  HashSlot *slots;
+  int groups;          // 组数，2的幂
+  int size;
+} HashArray;
+
+typedef struct {       // 散列表（Swiss table风格），扩容时逐步迁移
+  HashArray cur;       // 新键总是插入cur
+  HashArray old;       // 扩容迁移中的旧表，不在迁移时old.ctrl为NULL
+  int migrateNext;     // 旧表中下一个要迁移的组
+  int migrateLeft;     // 旧表中还剩多少组未迁移
+  double maxLoad;
+  int size;            // 键数（两张表之和）
+} HashTable;
+
+typedef struct { // B+树上的顺序遍历
+  const BPNode *leaf;
+  int pos;
+} BPTreeIter;
+
+typedef struct {  // Eytzinger（层序）布局的查找表
+  ElemType *b;    // b[1..n]按完全二叉树的层序存放，b[0]不用，按64字节对齐
+  int *rank;      // rank[k]为b[k]在原表中的下标
+  int n;
+} EytzingerTable;
+
 // Function declarations
 
 // Sequential search functions
@@ -26,16 +105,58 @@ int SeqSearch(SSTable ST, ElemType key); // With swap behavior
 int BinarySearch(SSTable ST, ElemType key);
 int BinarySearchRecursion(SSTable ST, ElemType key, int low, int high);
 
+// Eytzinger layout search, same indices as BinarySearch (ST.elem[0..TableLen))
+bool EytzingerBuild(SSTable ST, EytzingerTable &E); // ST.elem须有序
+int EytzingerSearch(const EytzingerTable &E, ElemType key);     // 返回在ST中的下标，不存在返回-1
+int EytzingerLowerBound(const EytzingerTable &E, ElemType key); // 第一个>=key的下标，都小于key时返回n
+void EytzingerDestroy(EytzingerTable &E);
+
+// Static B+-tree (S-tree), indices as in ST.elem[0..TableLen)
+bool STreeBuild(SSTable ST, STree &T); // ST.elem须有序
+int STreeSearch(const STree &T, ElemType key);     // 同BinarySearch，返回下标或-1
+int STreeLowerBound(const STree &T, ElemType key); // 第一个>=key的下标，没有则为n
+int STreeUpperBound(const STree &T, ElemType key); // 第一个>key的下标，没有则为n
+STreeIter STreeRange(const STree &T, ElemType lo, ElemType hi); // 遍历lo<=key<=hi的元素
+bool STreeNext(STreeIter &it, ElemType &key); // 取出下一个元素，遍历完返回false
+void STreeDestroy(STree &T);
+
 // Binary Search Tree functions
 BSTNode *BST_Search(BiTree T, ElemType key);
 bool BSTInsert(BiTree &T, ElemType key);
 void BSTCreate(BiTree &T, ElemType key[], int n);
+void BSTDestroy(BiTree &T); // T须为整棵树的根；由结点池建立的树整块释放slab，否则逐个free
+
+// Order-statistic AVL tree on BSTNode (multiset, duplicates kept in dup)
+bool OSTInsert(BiTree &T, ElemType key); // 插入一个key，内存不足返回false
+bool OSTDelete(BiTree &T, ElemType key); // 删除一个key，不存在返回false
+int OSTRank(BiTree T, ElemType key);     // 小于key的元素个数
+
+// B+-tree functions
+bool BPTreeInit(BPTree &T, int order = BPTREE_ORDER); // order至少为3
+bool BPTreeSearch(const BPTree &T, KeyType key);
+bool BPTreeInsert(BPTree &T, KeyType key);  // 已存在或内存不足返回false
+bool BPTreeDelete(BPTree &T, KeyType key);  // 不存在返回false
+bool BPTreeBulkLoad(BPTree &T, const KeyType keys[], int n); // T须已初始化，keys须非降序；替换原有内容，重复键只保留一个
+BPTreeIter BPTreeLowerBound(const BPTree &T, KeyType key); // 从第一个>=key的键开始遍历
+bool BPTreeNext(BPTreeIter &it, KeyType &key); // 取出下一个键，遍历完返回false
+void BPTreePrintBigger(const BPTree &T, KeyType k); // 从大到小输出>=k的键，同PrintBigger
+bool BPTreeIsValid(const BPTree &T);
+void BPTreeDestroy(BPTree &T); // 整块释放slab
+
+// Hash table (open addressing, SIMD control groups)
+bool HashInit(HashTable &H, int capacity = 0, double maxLoad = HASH_MAX_LOAD); // 预计键数，装填因子上限不超过15/16
+bool HashInsert(HashTable &H, KeyType key, ElemType value = 0); // 新插入返回true；已存在则更新value并返回false
+bool HashFind(const HashTable &H, KeyType key, ElemType *value = NULL);
+bool HashDelete(HashTable &H, KeyType key);
+void HashFindMany(const HashTable &H, const KeyType keys[], int n, bool found[],
+                  ElemType values[] = NULL); // 成批查找，查找前先预取各键所在的组
+void HashDestroy(HashTable &H);
 
 // BST utility functions
 bool IsBST(BiTree T);
 int GetLevel(BiTree T, ElemType e);
 void GetMinMax(BiTree T, ElemType &min, ElemType &max);
 void PrintBigger(BiTree T, ElemType k);
-BSTNode *KthSmall(BiTree T, int k);
+BSTNode *KthSmall(BiTree T, int k); // 第k小（从1开始，重复的键各占一位）
 
 #endif // SEARCH_H
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "MergeKernel.h"
 
 typedef int ElemType; // 数据类型
 
@@ -176,24 +177,12 @@ bool MergeSortedList(SqList &a, SqList &b, SqList &c) { // 7. 合并两个有序
     if (a.length == 0 || b.length == 0) { // 理论上一个为空可以返回另一个，题目没要求严格的判断就随意写了
         return false;
     }
-    if (a.length+b.length == 0 > MaxSize) {
+    if (a.length+b.length > MaxSize) {
         return false;
     }
 
-    int indexa = 0,
-        indexb = 0,
-        indexc = 0;
-    
-    while (indexa < a.length && indexb < b.length) {
-        if (a.data[indexa] < b.data[indexb]) {
-            c.data[indexc++] = a.data[indexa++];
-        } else {
-            c.data[indexc++] = b.data[indexb++];
-        }
-    }
-    while (indexa < a.length) c.data[indexc++] = a.data[indexa++];  // 这里还要处理剩余的元素，即长度不一致，剩下的直接插入后面即可
-    while (indexb < b.length) c.data[indexc++] = b.data[indexb++];
-    c.length = indexc; // 记得赋值长度。
+    MergeSortedInt(a.data, a.length, b.data, b.length, c.data); // 见MergeKernel.h：每次归并8个元素，剩余部分无分支处理
+    c.length = a.length + b.length; // 记得赋值长度。
     return true;
 }
 
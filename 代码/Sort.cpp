@@ -1,26 +1,80 @@
-#include "stdafx.h"
+#include "Sort.h"
+#include "MergeKernel.h"
+#include "PriorityQueue.h"
+#include <atomic>
+#include <climits>
+#include <cmath>
 #include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <chrono>
+// 插桩时排序网络的比较不便计数，统一走插入排序
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(SORT_INSTRUMENT)
+#define SORT_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+/**
+ * 插桩计数：以-DSORT_INSTRUMENT编译时，SORT_CMP(比较表达式)计一次元素比较，
+ * SORT_MOVES(k)计k次元素赋值（含暂存到临时变量）。
+ * 不定义时两个宏展开为原表达式和空语句，不产生任何开销。
+ * 并行排序的工作线程也会累加，所以用原子变量。
+ */
+#ifdef SORT_INSTRUMENT
+static std::atomic<long long> sortComparisons(0), sortMoves(0);
+#define SORT_CMP(expr)                                                         \
+  (sortComparisons.fetch_add(1, std::memory_order_relaxed), (expr))
+#define SORT_MOVES(k) sortMoves.fetch_add((k), std::memory_order_relaxed)
+#else
+#define SORT_CMP(expr) (expr)
+#define SORT_MOVES(k) ((void)0)
+#endif
+
+static const int SMALL_SORT_NET = 64;  // SmallSort排序网络能处理的最大长度
+static const int SMALL_SORT_LEAF = 32; // 分治排序的区间不超过该长度时交给SmallSort
 
 // Function to copy array
 void copyArray(ElemType src[], ElemType dest[], int n) {
   for (int i = 0; i < n; i++) {
     dest[i] = src[i];
   }
+  SORT_MOVES(n);
 }
 
 void swap(ElemType &a, ElemType &b) {
   ElemType tp = a;
   a = b;
   b = tp;
+  SORT_MOVES(3);
+}
+
+// Function to check if array is sorted
+bool isSorted(ElemType A[], int n) {
+  for (int i = 1; i < n; i++) {
+    if (A[i] < A[i - 1]) {
+      return false;
+    }
+  }
+  return true;
 }
 
 void InsertSort(ElemType A[], int n) { // 直接插入排序，从下标为1开始
   for (int i = 2; i <= n; i++) {
     int j;
     A[0] = A[i];
-    for (j = i - 1; A[j] > A[0]; j--)
+    for (j = i - 1; SORT_CMP(A[j] > A[0]); j--)
       A[j + 1] = A[j];
     A[j + 1] = A[0];
+    SORT_MOVES(i - j + 1); // 暂存、后移i-1-j个、放回
   }
 }
 
@@ -30,7 +84,7 @@ void HalfInsertSort(ElemType A[], int n) { // 折半插入排序
     A[0] = A[i];
     while (l <= r) {
       int mid = (l + r) / 2;
-      if (A[mid] > A[0])
+      if (SORT_CMP(A[mid] > A[0]))
         r = mid - 1;
       else
         l = mid + 1;
@@ -40,6 +94,7 @@ void HalfInsertSort(ElemType A[], int n) { // 折半插入排序
       A[j + 1] = A[j];
     }
     A[l] = A[0];
+    SORT_MOVES(i - l + 2);
   }
 }
 
@@ -68,13 +123,14 @@ void ShellSort(ElemType A[], int n) { // 希尔排序
   for (int dk = n / 2; dk >= 1;
        dk /= 2) { // 不断减小缩量，最终会缩小成1，也就变成直接插入排序
     for (int i = dk; i < n; i++) { // 遍历序列
-      if (A[i] < A[i - dk]) {      // 代表需要进行交换和移动
+      if (SORT_CMP(A[i] < A[i - dk])) { // 代表需要进行交换和移动
         tp = A[i];
-        for (j = i - dk; j >= 0 && tp < A[j];
+        for (j = i - dk; j >= 0 && SORT_CMP(tp < A[j]);
              j -= dk) { // 直接插入法寻找插入位置并移动，
           A[j + dk] = A[j];
         }
         A[j + dk] = tp; // 复制到插入位置
+        SORT_MOVES((i - j) / dk + 1);
       }
     }
   }
@@ -84,7 +140,7 @@ void BubbleSort(ElemType A[], int n) { // 冒泡排序
   for (int i = 0; i < n - 1; i++) {
     bool flag = true;
     for (int j = n - 1; j > i; j--) {
-      if (A[j - 1] > A[j])
+      if (SORT_CMP(A[j - 1] > A[j]))
         swap(A[j - 1], A[j]);
       flag = false;
     }
@@ -98,18 +154,24 @@ int Partition(ElemType A[], int l, int r) {
   ElemType pivot = A[l];
   int i = l, j = r;
   while (i < j) {
-    while (i < j && A[j] >= pivot)
+    while (i < j && SORT_CMP(A[j] >= pivot))
       j--;
     A[i] = A[j];
-    while (i < j && A[i] <= pivot)
+    while (i < j && SORT_CMP(A[i] <= pivot))
       i++;
     A[j] = A[i];
+    SORT_MOVES(2);
   }
   A[i] = pivot;
+  SORT_MOVES(2); // 暂存和放回枢轴
   return i;
 }
 
 void QuickSort(ElemType A[], int l, int r) { // 快速排序
+  if (r - l + 1 <= SMALL_SORT_LEAF) { // 小区间不再划分
+    SmallSort(A + l, r - l + 1);
+    return;
+  }
   if (l < r) {
     int pivotPos = Partition(A, l, r);
     QuickSort(A, l, pivotPos - 1);
@@ -121,7 +183,7 @@ void SelectSort(ElemType A[], int n) { // 选择排序
   for (int i = 0; i < n - 1; i++) {
     int min = i;
     for (int j = i + 1; j < n; j++) {
-      if (A[j] < A[min])
+      if (SORT_CMP(A[j] < A[min]))
         min = j;
     }
     if (min != i)
@@ -129,17 +191,19 @@ void SelectSort(ElemType A[], int n) { // 选择排序
   }
 }
 
-void Merge(ElemType A[], int l, int m, int r) {
-  const static int N = 20;
-  static ElemType *B = (ElemType *)malloc((N + 1) * sizeof(ElemType));
-
+static void MergeWith(ElemType A[], int l, int m, int r,
+                      ElemType B[]) { // 归并A[l..m]和A[m+1..r]，B为辅助数组，至少r-l+1个元素
+  B -= l; // 让B与A下标一致
   for (int k = l; k <= r; k++) {
     B[k] = A[k];
   }
 
+#ifdef SORT_HAVE_AVX2
+  MergeSortedInt(B + l, m - l + 1, B + m + 1, r - m, A + l); // 见MergeKernel.h
+#else
   int i, j, k;
   for (i = l, j = m + 1, k = i; i <= m && j <= r; k++) {
-    if (B[i] <= B[j])
+    if (SORT_CMP(B[i] <= B[j]))
       A[k] = B[i++];
     else
       A[k] = B[j++];
@@ -149,17 +213,37 @@ void Merge(ElemType A[], int l, int m, int r) {
     A[k++] = B[i++];
   while (j <= r)
     A[k++] = B[j++];
+  SORT_MOVES(2 * (r - l + 1));
+#endif
+}
+
+void Merge(ElemType A[], int l, int m, int r) { // 单独调用时临时申请r-l+1个元素的辅助数组
+  std::vector<ElemType> B(r - l + 1);
+  MergeWith(A, l, m, r, B.data());
 }
 
-void MergeSort(ElemType A[], int l, int r) {
+static void MergeSortWith(ElemType A[], int l, int r, ElemType B[]) {
+  if (r - l + 1 <= SMALL_SORT_LEAF) { // 小区间不再二分
+    SmallSort(A + l, r - l + 1);
+    return;
+  }
   if (l < r) {
     int mid = (l + r) / 2;
-    MergeSort(A, l, mid);
-    MergeSort(A, mid + 1, r);
-    Merge(A, l, mid, r);
+    MergeSortWith(A, l, mid, B);
+    MergeSortWith(A, mid + 1, r, B);
+    MergeWith(A, l, mid, r, B);
   }
 }
 
+void MergeSort(ElemType A[], int l, int r) { // 辅助数组按区间长度申请一次，各层共用，排完即释放
+  if (r - l + 1 <= SMALL_SORT_LEAF) {
+    MergeSortWith(A, l, r, NULL);
+    return;
+  }
+  std::vector<ElemType> B(r - l + 1);
+  MergeSortWith(A, l, r, B.data());
+}
+
 void HeadAdjust(ElemType A[], int k, int n) { // 调整以k为根的堆
   /**
    * 思路就是一直往更大的子树走
@@ -169,17 +253,19 @@ void HeadAdjust(ElemType A[], int k, int n) { // 调整以k为根的堆
    */
   A[0] = A[k];                          // 暂存子树根结点
   for (int i = 2 * k; i <= n; i *= 2) { // 一直走向左子树
-    if (i < n && A[i] < A[i + 1]) {     // 如果兄弟（根的右子树）值要大
+    if (i < n && SORT_CMP(A[i] < A[i + 1])) { // 如果兄弟（根的右子树）值要大
       i++;                              // 则走向右子树
     }
-    if (A[0] >= A[i])
+    if (SORT_CMP(A[0] >= A[i]))
       break; // 如果 根结点比i大 则跳出
     else {
       A[k] = A[i]; // 否则说明i更大，则i放入根的位置。
       k = i;
+      SORT_MOVES(1);
     }
   }
   A[k] = A[0]; // 将根放回序列中
+  SORT_MOVES(2);
 }
 
 void BuildMaxHeap(ElemType A[], int n) { // 建立堆
@@ -188,7 +274,7 @@ void BuildMaxHeap(ElemType A[], int n) { // 建立堆
   }
 }
 
-void HeapSort(ElemType A[], int n) { // 堆排序
+void BinaryHeapSort(ElemType A[], int n) { // 堆排序（教材版，二叉堆）
   BuildMaxHeap(A, n);
   for (int i = n; i > 1; i--) { // 从后往前交换
     swap(A[1], A[i]);           // A[1]是此时堆最大的，放到最后
@@ -196,6 +282,25 @@ void HeapSort(ElemType A[], int n) { // 堆排序
   }
 }
 
+static void HeapSort4(ElemType a[], int n) { // 4叉堆排序，下标从0开始
+  auto greater = [](ElemType x, ElemType y) { return SORT_CMP(x > y); };
+  auto moved = [](size_t) { SORT_MOVES(1); }; // 堆调整每写入一个位置调用一次
+  DAryHeap<4>::Heapify(a, n, greater, moved);
+  for (int i = n - 1; i > 0; i--) {
+    swap(a[0], a[i]);                               // 堆顶最大，放到最后
+    DAryHeap<4>::SiftDown(a, 0, i, greater, moved); // 调整a[0..i)
+  }
+}
+
+void HeapSort(ElemType A[], int n) { // 堆排序（4叉堆），从下标为1开始，不使用A[0]
+  /**
+   * 和BinaryHeapSort步骤相同，堆换成PriorityQueue.h中的DAryHeap<4>：
+   * 层数减半，下沉用Floyd自底向上的方式，每层少一次和根的比较。
+   * 大根堆，所以比较函数取“大于”。
+   */
+  HeapSort4(A + 1, n);
+}
+
 // 8.3 作业
 
 void Bubble2Sort(ElemType A[], int n) { // 2. 双向冒泡排序
@@ -204,14 +309,14 @@ void Bubble2Sort(ElemType A[], int n) { // 2. 双向冒泡排序
   while (l < r && flag) { // 双向逼近
     flag = false;
     for (int i = l; i < r; i++) { // 从前往后
-      if (A[i] > A[i + 1]) {      // 如果前面大于后面则交换
+      if (SORT_CMP(A[i] > A[i + 1])) { // 如果前面大于后面则交换
         swap(A[i], A[i + 1]);
         flag = true;
       }
     }
     r--;                          // 此时一定把最大值冒到r位置了，可以r--
     for (int i = r; i > l; i--) { // 从后往前
-      if (A[i] < A[i - 1]) {      // 如果后面小于前面则交换
+      if (SORT_CMP(A[i] < A[i - 1])) { // 如果后面小于前面则交换
         swap(A[i], A[i - 1]);
         flag = true;
       }
@@ -239,20 +344,26 @@ void QuickMove(ElemType A[], int n) { // 3. 将所有奇数移动到偶数前
 }
 
 void QuickSort2(ElemType A[], int low, int high) { // 4. 每次随机选取枢轴的快排
+  if (high - low + 1 <= SMALL_SORT_LEAF) {         // 小区间不再划分
+    SmallSort(A + low, high - low + 1);
+    return;
+  }
   if (low < high) {                                // 不为空
     int index = low + rand() % (high - low + 1);   // 随机选取枢轴
     swap(A[index], A[low]);                        // 还是放到low位置，方便处理
     ElemType pivot = A[low];                       // 这样枢轴还是第一个元素
     int l = low, r = high;
     while (l < r) { // 不断从两端逼近
-      while (l < r && A[r] >= pivot)
+      while (l < r && SORT_CMP(A[r] >= pivot))
         r--;       // 从右往左找小于pivot元素的位置
       A[l] = A[r]; // 移动到左边
-      while (l < r && A[l] <= pivot)
+      while (l < r && SORT_CMP(A[l] <= pivot))
         l++;       // 从左往右找大于pivot元素的位置
       A[r] = A[l]; // 移动到右边
+      SORT_MOVES(2);
     }
     A[l] = pivot; // 最后 l=r 也就是pivot的位置
+    SORT_MOVES(2);
 
     QuickSort(A, low, l - 1); // 对左右部分分别递归
     QuickSort(A, l + 1, high);
@@ -265,6 +376,10 @@ ElemType KthElement(ElemType A[], int low, int high,
    * 要求O(n)找到第k小，不能使用排序再返回的方式
    * 但是我们可以利用快排划分的方式，让k-1个比m小的在左边，则k位就是我们要的
    */
+  if (high - low + 1 <= SMALL_SORT_LEAF) { // 小区间直接排好取第k位
+    SmallSort(A + low, high - low + 1);
+    return A[k];
+  }
   int pivot = A[low]; // 第一个作为枢轴
   int ltp = low, htp = high;
   while (low < high) {
@@ -350,191 +465,1616 @@ SetSlice(ElemType A[],
   return s2 - s1;
 }
 
-// ANSI color codes for terminal output
-#define RESET "\033[0m"
-#define RED "\033[31m"
-#define GREEN "\033[32m"
-#define YELLOW "\033[33m"
-#define BLUE "\033[34m"
-#define MAGENTA "\033[35m"
-#define CYAN "\033[36m"
-#define WHITE "\033[37m"
-#define BOLD "\033[1m"
+// 工程化排序
 
-// ...existing code...
+static void InsertRun(ElemType A[], int l, int r) { // 对A[l..r)直接插入排序（下标从0开始，无哨兵）
+  for (int i = l + 1; i < r; i++) {
+    ElemType tp = A[i];
+    int j;
+    for (j = i - 1; j >= l && SORT_CMP(A[j] > tp); j--)
+      A[j + 1] = A[j];
+    A[j + 1] = tp;
+    SORT_MOVES(i - j + 1);
+  }
+}
 
-// Function to check if array is sorted
-bool isSorted(ElemType A[], int n) {
-  for (int i = 1; i < n; i++) {
-    if (A[i] < A[i - 1]) {
-      return false;
+#ifdef SORT_HAVE_AVX2
+/**
+ * AVX2排序网络：一个寄存器放8个int
+ * 1. 每个寄存器内部用双调排序网络排好（6步比较交换）
+ * 2. 再把相邻的有序寄存器两两做双调归并：8+8->16，16+16->32，32+32->64
+ * 比较交换都是min/max加blend，没有依赖数据的分支
+ */
+static const int NET_PARTNER[6][8] = { // 第s步每个位置与哪个位置比较
+    {1, 0, 3, 2, 5, 4, 7, 6}, {2, 3, 0, 1, 6, 7, 4, 5},
+    {1, 0, 3, 2, 5, 4, 7, 6}, {4, 5, 6, 7, 0, 1, 2, 3},
+    {2, 3, 0, 1, 6, 7, 4, 5}, {1, 0, 3, 2, 5, 4, 7, 6}};
+static const int NET_TAKEMAX[6][8] = { // 第s步每个位置取较大值(-1)还是较小值(0)
+    {0, -1, -1, 0, 0, -1, -1, 0}, {0, 0, -1, -1, -1, -1, 0, 0},
+    {0, -1, 0, -1, -1, 0, -1, 0}, {0, 0, 0, 0, -1, -1, -1, -1},
+    {0, 0, -1, -1, 0, 0, -1, -1}, {0, -1, 0, -1, 0, -1, 0, -1}};
+
+__attribute__((target("avx2"))) static inline __m256i
+NetStep(__m256i v, int s) { // 寄存器内的一步比较交换
+  __m256i partner = _mm256_permutevar8x32_epi32(
+      v, _mm256_loadu_si256((const __m256i *)NET_PARTNER[s]));
+  return _mm256_blendv_epi8(
+      _mm256_min_epi32(v, partner), _mm256_max_epi32(v, partner),
+      _mm256_loadu_si256((const __m256i *)NET_TAKEMAX[s]));
+}
+
+__attribute__((target("avx2"))) static inline __m256i
+Reverse8(__m256i v) {
+  return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+__attribute__((target("avx2"))) static void
+BitonicMergeRegs(__m256i v[], int cnt) { // v[0..cnt)共cnt*8个元素构成双调序列，归并成升序
+  for (int d = cnt / 2; d >= 1; d /= 2) { // 寄存器之间的半清洁器
+    for (int i = 0; i < cnt; i++) {
+      if (i & d)
+        continue;
+      __m256i lo = _mm256_min_epi32(v[i], v[i + d]);
+      v[i + d] = _mm256_max_epi32(v[i], v[i + d]);
+      v[i] = lo;
     }
   }
+  for (int i = 0; i < cnt; i++) // 寄存器内部：距离4、2、1
+    v[i] = NetStep(NetStep(NetStep(v[i], 3), 4), 5);
+}
+
+__attribute__((target("avx2"))) static void SmallSortAVX2(ElemType A[],
+                                                          int n) { // n<=64
+  int regs = 1;
+  while (regs * 8 < n)
+    regs *= 2; // 1、2、4、8个寄存器，分别对应8/16/32/64的排序网络
+  ElemType buf[64];
+  for (int i = 0; i < regs * 8; i++)
+    buf[i] = i < n ? A[i] : INT_MAX; // 不足的位置用最大值填充，排完落在末尾
+  __m256i v[8];
+  for (int i = 0; i < regs; i++) {
+    v[i] = _mm256_loadu_si256((const __m256i *)(buf + 8 * i));
+    for (int s = 0; s < 6; s++)
+      v[i] = NetStep(v[i], s);
+  }
+  for (int w = 1; w < regs; w *= 2) {
+    for (int g = 0; g < regs; g += 2 * w) {
+      for (int i = 0; i < w / 2; i++) { // 后一半寄存器整体倒序，两段拼成双调序列
+        __m256i tp = v[g + w + i];
+        v[g + w + i] = v[g + 2 * w - 1 - i];
+        v[g + 2 * w - 1 - i] = tp;
+      }
+      for (int i = 0; i < w; i++)
+        v[g + w + i] = Reverse8(v[g + w + i]);
+      BitonicMergeRegs(v + g, 2 * w);
+    }
+  }
+  for (int i = 0; i < regs; i++)
+    _mm256_storeu_si256((__m256i *)(buf + 8 * i), v[i]);
+  for (int i = 0; i < n; i++)
+    A[i] = buf[i];
+}
+
+static bool HasAVX2() { // CPUID检测，只检测一次
+  static const bool has = __builtin_cpu_supports("avx2");
+  return has;
+}
+#endif
+
+void SmallSort(ElemType A[], int n) { // 小区间排序，下标从0开始
+  /**
+   * 各种分治排序递归到小区间时统一调用这里。
+   * n<=64且CPU支持AVX2时走排序网络，否则退回直接插入排序。
+   */
+  if (n < 2)
+    return;
+#ifdef SORT_HAVE_AVX2
+  if (n <= SMALL_SORT_NET && HasAVX2()) {
+    SmallSortAVX2(A, n);
+    return;
+  }
+#endif
+  InsertRun(A, 0, n);
+}
+
+static int Median3(ElemType A[], int a, int b, int c) { // 返回三者中位数的下标
+  if (SORT_CMP(A[a] < A[b])) {
+    if (SORT_CMP(A[b] < A[c]))
+      return b;
+    return SORT_CMP(A[a] < A[c]) ? c : a;
+  }
+  if (SORT_CMP(A[a] < A[c]))
+    return a;
+  return SORT_CMP(A[b] < A[c]) ? c : b;
+}
+
+static void ChoosePivot(ElemType A[], int l, int r) { // 选取枢轴并放到A[l]
+  /**
+   * Partition固定以A[l]为枢轴，有序或逆序输入会退化成O(n^2)
+   * 这里先取三数中值（区间较大时取九数中值 ninther），再换到A[l]，Partition本身无需改动
+   */
+  int len = r - l + 1, m = l + (r - l) / 2, mid;
+  if (len > 128) {
+    int s = len / 8;
+    mid = Median3(A, Median3(A, l, l + s, l + 2 * s),
+                  Median3(A, m - s, m, m + s),
+                  Median3(A, r - 2 * s, r - s, r));
+  } else {
+    mid = Median3(A, l, m, r);
+  }
+  swap(A[l], A[mid]);
+}
+
+static void HeapSortRange(ElemType A[], int l, int r) { // 对A[l..r]堆排序
+  HeapSort4(A + l, r - l + 1);
+}
+
+static const int BLOCK_SIZE = 64; // 块划分每次扫描的元素数，偏移量用unsigned char存放
+
+int BlockPartition(ElemType A[], int l, int r) { // 块划分（BlockQuicksort），可直接替换Partition
+  /**
+   * 与Partition约定相同：以A[l]为枢轴，返回枢轴最终位置，左边<=枢轴，右边>=枢轴。
+   * Partition的内层while每比较一次就要判断是否停下，随机数据上约一半预测失败。
+   * 这里两端各取一块BLOCK_SIZE个元素：
+   * 1. 扫描左块，把>=pivot的元素偏移记入offL；扫描右块，把<=pivot的元素偏移记入offR。
+   *    写入位置总是offL[numL]，是否保留只体现为numL是否+1，没有依赖数据的分支
+   * 2. 两边各取min(numL,numR)个成对交换
+   * 3. 哪边的偏移用完了就前进一整块
+   * 剩余不足两块的部分再用普通的双指针扫描收尾。
+   */
+  ElemType pivot = A[l];
+  unsigned char offL[BLOCK_SIZE], offR[BLOCK_SIZE];
+  int i = l + 1, j = r; // [i,j]为尚未划分完的部分
+  int numL = 0, numR = 0, startL = 0, startR = 0;
+  while (j - i + 1 >= 2 * BLOCK_SIZE) {
+    if (numL == 0) {
+      startL = 0;
+      for (int k = 0; k < BLOCK_SIZE; k++) {
+        offL[numL] = k;
+        numL += SORT_CMP(A[i + k] >= pivot);
+      }
+    }
+    if (numR == 0) {
+      startR = 0;
+      for (int k = 0; k < BLOCK_SIZE; k++) {
+        offR[numR] = k;
+        numR += SORT_CMP(A[j - k] <= pivot);
+      }
+    }
+    int num = numL < numR ? numL : numR;
+    for (int k = 0; k < num; k++)
+      swap(A[i + offL[startL + k]], A[j - offR[startR + k]]);
+    numL -= num, numR -= num;
+    startL += num, startR += num;
+    if (numL == 0)
+      i += BLOCK_SIZE;
+    if (numR == 0)
+      j -= BLOCK_SIZE;
+  }
+
+  while (true) { // 此时A[l+1..i-1]<=pivot，A[j+1..r]>=pivot，中间部分重新扫描
+    while (i <= j && SORT_CMP(A[i] < pivot))
+      i++;
+    while (i <= j && SORT_CMP(A[j] > pivot))
+      j--;
+    if (i >= j)
+      break;
+    swap(A[i], A[j]);
+    i++, j--;
+  }
+  int pivotPos = i == j ? i : i - 1; // i==j时A[i]恰好等于pivot
+  swap(A[l], A[pivotPos]);
+  return pivotPos;
+}
+
+static void IntroSortLoop(ElemType A[], int l, int r, int depth,
+                          PartitionFunc partition) {
+  while (r - l + 1 > SMALL_SORT_LEAF) {
+    if (depth == 0) { // 划分层数过深，说明枢轴选得太差，改用堆排序保证O(nlogn)
+      HeapSortRange(A, l, r);
+      return;
+    }
+    depth--;
+    ChoosePivot(A, l, r);
+    int pivotPos = partition(A, l, r);
+    if (pivotPos - l < r - pivotPos) { // 只对较短的一侧递归，较长的一侧循环处理
+      IntroSortLoop(A, l, pivotPos - 1, depth, partition);
+      l = pivotPos + 1;
+    } else {
+      IntroSortLoop(A, pivotPos + 1, r, depth, partition);
+      r = pivotPos - 1;
+    }
+  }
+  SmallSort(A + l, r - l + 1);
+}
+
+static int DepthLimit(int n) { // 允许的划分层数 2logn
+  int depth = 0;
+  for (int m = n; m > 1; m /= 2)
+    depth++;
+  return 2 * depth;
+}
+
+void IntroSort(ElemType A[], int n,
+               PartitionFunc partition) { // 内省排序，从下标为1开始
+  /**
+   * 快排 + 堆排序 + 插入排序的组合：
+   * 1. 三数/九数取中选枢轴，避免有序输入退化
+   * 2. 递归深度超过2logn时对该区间改用HeapSort，最坏O(nlogn)
+   * 3. 小区间用SmallSort收尾
+   * 4. 只递归较短一侧，栈深度不超过logn
+   * partition可选Partition或BlockPartition。
+   */
+  if (n < 2)
+    return;
+  IntroSortLoop(A, 1, n, DepthLimit(n), partition);
+}
+
+static const int PARALLEL_GRAIN = 1 << 14; // 区间短于该长度时不再拆分，直接串行排序
+
+typedef struct {
+  int l, r;  // 待排序区间A[l..r]
+  int depth; // 剩余可划分层数
+} SortTask;
+
+struct WorkerQueue {          // 每个线程一个双端队列
+  std::mutex lock;
+  std::deque<SortTask> tasks; // 自己从尾部取，其他线程从头部偷
+};
+
+struct TaskPool {
+  ElemType *A;
+  PartitionFunc partition;
+  std::vector<WorkerQueue> queues;
+  std::atomic<int> pending; // 已入队但尚未排完的区间数，为0时所有线程退出
+
+  explicit TaskPool(int threads) : queues(threads) {}
+};
+
+static void PushTask(TaskPool &pool, int id, SortTask t) {
+  pool.pending++;
+  std::lock_guard<std::mutex> guard(pool.queues[id].lock);
+  pool.queues[id].tasks.push_back(t);
+}
+
+static bool PopTask(TaskPool &pool, int id, SortTask &t) { // 取自己最新放入的区间
+  WorkerQueue &q = pool.queues[id];
+  std::lock_guard<std::mutex> guard(q.lock);
+  if (q.tasks.empty())
+    return false;
+  t = q.tasks.back();
+  q.tasks.pop_back();
   return true;
 }
 
-// Function to print array with colors
-void printArray(ElemType A[], int n, const char *sortName) {
-  printf(BOLD CYAN "=== %s Result ===" RESET "\n", sortName);
+static bool StealTask(TaskPool &pool, int id, SortTask &t) { // 从别的线程偷最早放入（通常最大）的区间
+  int n = pool.queues.size();
+  for (int k = 1; k < n; k++) {
+    WorkerQueue &q = pool.queues[(id + k) % n];
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (!q.tasks.empty()) {
+      t = q.tasks.front();
+      q.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
 
-  // Print array elements
-  printf("Array: ");
-  for (int i = 0; i < n; i++) {
-    if (i > 0 && A[i] < A[i - 1]) {
-      printf(RED "%d " RESET, A[i]); // Red for incorrect order
+static void RunTask(TaskPool &pool, int id, SortTask t) {
+  ElemType *A = pool.A;
+  while (t.r - t.l + 1 > PARALLEL_GRAIN && t.depth > 0) {
+    t.depth--;
+    ChoosePivot(A, t.l, t.r);
+    int pivotPos = pool.partition(A, t.l, t.r);
+    SortTask other = t;
+    if (pivotPos - t.l < t.r - pivotPos) { // 较长的一侧交给队列，留给空闲线程偷
+      other.l = pivotPos + 1;
+      t.r = pivotPos - 1;
     } else {
-      printf(GREEN "%d " RESET, A[i]); // Green for correct order
+      other.r = pivotPos - 1;
+      t.l = pivotPos + 1;
     }
+    if (other.l < other.r)
+      PushTask(pool, id, other);
   }
+  IntroSortLoop(A, t.l, t.r, t.depth, pool.partition); // 区间已足够小（或层数用尽），串行收尾
+  pool.pending--;
+}
 
-  printf("\n");
+static void SortWorker(TaskPool *pool, int id) {
+  SortTask t;
+  while (pool->pending > 0) {
+    if (PopTask(*pool, id, t) || StealTask(*pool, id, t))
+      RunTask(*pool, id, t);
+    else
+      std::this_thread::yield();
+  }
+}
 
-  // Check if sorted correctly
-  if (isSorted(A, n)) {
-    printf(BOLD GREEN "✓ PASSED: Array is correctly sorted!" RESET "\n");
-  } else {
-    printf(BOLD RED "✗ FAILED: Array is NOT sorted correctly!" RESET "\n");
+void ParallelQuickSort(ElemType A[], int n, int threads,
+                       PartitionFunc partition) { // 并行快排，从下标为1开始
+  /**
+   * 工作窃取（work-stealing）：
+   * 每个线程不断划分自己手上的区间，一侧放入自己的队列，另一侧继续划分，
+   * 直到区间短于PARALLEL_GRAIN时用IntroSort的串行流程排完。
+   * 空闲线程从其他线程队列头部偷取区间，因此负载会自动均衡。
+   * 划分后的各个子区间互不重叠，线程之间无需再加锁。
+   * threads<=0时使用硬件线程数。
+   */
+  if (n < 2)
+    return;
+  if (threads <= 0)
+    threads = std::thread::hardware_concurrency();
+  if (threads <= 1 || n <= PARALLEL_GRAIN) {
+    IntroSortLoop(A, 1, n, DepthLimit(n), partition);
+    return;
   }
-  printf("\n");
+
+  TaskPool pool(threads);
+  pool.A = A;
+  pool.partition = partition;
+  pool.pending = 0;
+  SortTask all = {1, n, DepthLimit(n)};
+  PushTask(pool, 0, all);
+
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads; i++)
+    workers.push_back(std::thread(SortWorker, &pool, i));
+  SortWorker(&pool, 0); // 调用线程自己也参与排序
+  for (size_t i = 0; i < workers.size(); i++)
+    workers[i].join();
 }
-// Function to test all sorting algorithms
-void testAllSorts() {
-  ElemType original[] = {114514, 95422, 28902, 59695, 51038,  92653,  22568,
-                         62664,  65812, 85193, 6970,  117181, 108792, 1152,
-                         99284,  97047, 52711, 18498, 57024,  62044};
-  int n = sizeof(original) / sizeof(ElemType) - 1; // 减1因为第一个元素是哨兵
-  ElemType testArray[21];                          // 需要额外空间给哨兵
 
-  printf(BOLD YELLOW "========== SORTING ALGORITHMS TEST ==========" RESET
-                     "\n\n");
+void FlagPartition(ElemType A[], int l, int r, ElemType pivot, int &lt,
+                   int &gt) { // 荷兰国旗划分的一般形式
+  /**
+   * 与FlagArrange相同的三指针扫描，只是把0/1/2换成 小于/等于/大于 pivot：
+   * 结束后A[l..lt-1] < pivot，A[lt..gt] == pivot，A[gt+1..r] > pivot
+   */
+  int i = l, j = l, k = r;
+  while (j <= k) {
+    if (SORT_CMP(A[j] < pivot)) { // 小于，换到左边
+      swap(A[i], A[j]);
+      i++, j++;
+    } else if (SORT_CMP(A[j] > pivot)) { // 大于，换到右边，换回来的元素还没看过，j不动
+      swap(A[j], A[k]);
+      k--;
+    } else { // 等于，留在中间
+      j++;
+    }
+  }
+  lt = i;
+  gt = k;
+}
 
-  // Print original array (skip sentinel at index 0)
-  printf(BOLD WHITE "Original Array:" RESET "\n");
-  for (int i = 1; i <= n; i++) {
-    printf("%d ", original[i]);
+static void QuickSort3WayLoop(ElemType A[], int l, int r, int depth) {
+  while (r - l + 1 > SMALL_SORT_LEAF) {
+    if (depth == 0) {
+      RadixSortInPlace(A + l, r - l + 1);
+      return;
+    }
+    depth--;
+    int lt, gt;
+    ChoosePivot(A, l, r);
+    FlagPartition(A, l, r, A[l], lt, gt);
+    if (lt - l < r - gt) {
+      QuickSort3WayLoop(A, l, lt - 1, depth);
+      l = gt + 1;
+    } else {
+      QuickSort3WayLoop(A, gt + 1, r, depth);
+      r = lt - 1;
+    }
   }
-  printf("\n\n");
+  if (l < r)
+    SmallSort(A + l, r - l + 1);
+}
+
+void QuickSort3Way(ElemType A[], int l, int r) { // 三路快排
+  /**
+   * Partition把等于枢轴的元素分到两侧，重复值很多时每层只能排除一个元素。
+   * 这里用FlagPartition一次把等于枢轴的元素全部归位，只对小于和大于两段继续排序，
+   * 只有k种不同值时递归层数不超过k。
+   * 枢轴选取、只递归较短一侧与IntroSort相同；层数超过2logn时改用RadixSortInPlace，
+   * 它不需要A[l-1]暂存，下标从0开始的区间也能用。
+   */
+  QuickSort3WayLoop(A, l, r, DepthLimit(r - l + 1));
+}
 
-  // Test InsertSort (uses 1-based indexing with sentinel)
-  for (int i = 0; i <= n; i++) {
-    testArray[i] = original[i];
+static const int FR_SAMPLE_MIN = 600; // 区间超过该长度时用Floyd-Rivest抽样选枢轴
+
+static void SelectRange(ElemType A[], int l, int r, int k);
+
+static ElemType MedianOfMedians(ElemType A[], int l, int r) { // 中位数的中位数（BFPRT），保证划分后两侧都至少有3/10
+  int groups = (r - l + 1 + 4) / 5;
+  for (int g = 0; g < groups; g++) { // 每5个一组排好，组中位数集中放到A[l..l+groups-1]
+    int gl = l + 5 * g, len = r - gl + 1 < 5 ? r - gl + 1 : 5;
+    SmallSort(A + gl, len);
+    swap(A[l + g], A[gl + (len - 1) / 2]);
   }
-  InsertSort(testArray, n);
-  // Print from index 1 to n for 1-based algorithms
-  printf(BOLD CYAN "=== Insert Sort Result ===" RESET "\n");
-  if (isSorted(&testArray[1], n)) { // Check sorting from index 1
-    printf(BOLD GREEN "✓ PASSED: Array is correctly sorted!" RESET "\n");
-  } else {
-    printf(BOLD RED "✗ FAILED: Array is NOT sorted correctly!" RESET "\n");
+  int mid = l + (groups - 1) / 2;
+  SelectRange(A, l, l + groups - 1, mid); // 再递归选出这些中位数的中位数
+  return A[mid];
+}
+
+static void SelectRange(ElemType A[], int l, int r, int k) { // 在A[l..r]中把第k位放好
+  /**
+   * 结束后A[k]就是排序后应在k位的元素，且A[l..k-1]<=A[k]<=A[k+1..r]
+   * 1. 大区间用Floyd-Rivest：在k附近按比例取一个约n^(2/3)的小区间，先递归在小区间里选出第k位，
+   *    以它为枢轴，划分后k所在一侧通常只剩很少的元素
+   * 2. 小区间用三数/九数取中
+   * 3. 划分轮数超过2logn仍未结束（枢轴持续选得不好）时，改用中位数的中位数，最坏O(n)
+   * 划分用FlagPartition，等于枢轴的元素一次归位，重复值多时也不会退化。
+   */
+  int budget = DepthLimit(r - l + 1);
+  while (r - l + 1 > SMALL_SORT_LEAF) {
+    ElemType pivot;
+    if (budget > 0) {
+      budget--;
+      if (r - l + 1 > FR_SAMPLE_MIN) {
+        double n = r - l + 1, i = k - l + 1;
+        double z = log(n), s = 0.5 * exp(2 * z / 3);
+        double sd = 0.5 * sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1 : 1);
+        int sl = (int)(k - i * s / n + sd), sr = (int)(k + (n - i) * s / n + sd);
+        SelectRange(A, sl > l ? sl : l, sr < r ? sr : r, k);
+        pivot = A[k];
+      } else {
+        ChoosePivot(A, l, r);
+        pivot = A[l];
+      }
+    } else {
+      pivot = MedianOfMedians(A, l, r);
+    }
+    int lt, gt;
+    FlagPartition(A, l, r, pivot, lt, gt);
+    if (k < lt)
+      r = lt - 1;
+    else if (k > gt)
+      l = gt + 1;
+    else
+      return; // k落在等于枢轴的一段
+  }
+  SmallSort(A + l, r - l + 1);
+}
+
+ElemType NthElement(ElemType A[], int n, int k) { // 选出第k小（k从0开始）
+  if (n <= 0) // 没有元素，不访问A
+    return 0;
+  if (k < 0) // 同PartialSort，越界的k截到[0,n)内
+    k = 0;
+  if (k >= n)
+    k = n - 1;
+  SelectRange(A, 0, n - 1, k);
+  return A[k];
+}
+
+void PartialSort(ElemType A[], int n, int k) { // 部分排序：A[0..k)为最小的k个且有序，其余次序任意
+  /**
+   * 先用选择把第k-1位放好，左边就是最小的k个，再只对这k个排序。
+   * O(n + klogk)，不需要额外空间。
+   */
+  if (k > n)
+    k = n;
+  if (k <= 0)
+    return;
+  if (k < n)
+    SelectRange(A, 0, n - 1, k - 1);
+  IntroSortLoop(A, 0, k - 1, DepthLimit(k), Partition);
+}
+
+static const int TOPK_BATCH = 64; // TopK每批用门槛筛选的元素数
+
+bool TopKInit(TopKState &S, int k, bool largest) { // 初始化，保留最小（largest时为最大）的k个
+  if (k < 0)
+    return false;
+  S.heap = (ElemType *)malloc((k > 0 ? k : 1) * sizeof(ElemType));
+  if (S.heap == NULL)
+    return false;
+  S.k = k;
+  S.size = 0;
+  S.largest = largest;
+  return true;
+}
+
+template <class Better>
+static void TopKFeed(TopKState &S, const ElemType A[], int n, Better better) {
+  /**
+   * 堆中保存目前最好的k个，堆顶是其中最差的一个，即新元素要进入必须超过的门槛。
+   * 1. 堆未满时直接放入，满了就O(k)建堆
+   * 2. 之后每批TOPK_BATCH个元素：先无分支地和门槛比较，只记下通过的位置；
+   *    再对通过的元素逐个替换堆顶。流的后段几乎没有元素能通过门槛，
+   *    每个元素只花一次比较，也没有难预测的分支
+   * 门槛只会越来越严，所以批内用旧门槛筛出的候选替换前要再和堆顶比一次。
+   */
+  auto worse = [&](ElemType x, ElemType y) { return better(y, x); }; // 堆顶为最差的
+  int i = 0;
+  while (i < n && S.size < S.k) {
+    S.heap[S.size++] = A[i++];
+    if (S.size == S.k)
+      DAryHeap<4>::Heapify(S.heap, S.k, worse);
+  }
+  unsigned char offs[TOPK_BATCH];
+  for (; i < n; i += TOPK_BATCH) {
+    int len = n - i < TOPK_BATCH ? n - i : TOPK_BATCH, cnt = 0;
+    ElemType thr = S.heap[0];
+    for (int j = 0; j < len; j++) {
+      offs[cnt] = (unsigned char)j;
+      cnt += better(A[i + j], thr);
+    }
+    for (int c = 0; c < cnt; c++) {
+      ElemType x = A[i + offs[c]];
+      if (better(x, S.heap[0])) {
+        S.heap[0] = x;
+        DAryHeap<4>::SiftDown(S.heap, 0, S.k, worse);
+      }
+    }
+  }
+}
+
+void TopKPush(TopKState &S, const ElemType A[], int n) { // 送入一块数据A[0..n)
+  if (S.k == 0)
+    return;
+  if (S.largest)
+    TopKFeed(S, A, n, [](ElemType x, ElemType y) { return SORT_CMP(x > y); });
+  else
+    TopKFeed(S, A, n, [](ElemType x, ElemType y) { return SORT_CMP(x < y); });
+}
+
+int TopKResult(const TopKState &S, ElemType out[]) { // 按从好到差写入out，返回个数，不影响后续送入
+  copyArray(S.heap, out, S.size);
+  if (S.size > 1)
+    IntroSortLoop(out, 0, S.size - 1, DepthLimit(S.size), Partition);
+  if (S.largest)
+    for (int i = 0, j = S.size - 1; i < j; i++, j--)
+      swap(out[i], out[j]);
+  return S.size;
+}
+
+void TopKDestroy(TopKState &S) {
+  free(S.heap);
+  S.heap = NULL;
+  S.k = S.size = 0;
+}
+
+int TopK(const ElemType A[], int n, int k, ElemType out[],
+         bool largest) { // 一次性求A[0..n)中最小（最大）的k个，有序写入out
+  TopKState S;
+  if (!TopKInit(S, k, largest))
+    return 0;
+  TopKPush(S, A, n);
+  int cnt = TopKResult(S, out);
+  TopKDestroy(S);
+  return cnt;
+}
+
+static void MultiSelectRange(ElemType A[], int l, int r, const int ks[],
+                             int kl, int kr) { // ks[kl..kr]都落在[l,r]内
+  if (kl > kr)
+    return;
+  if (r - l + 1 <= SMALL_SORT_LEAF) {
+    SmallSort(A + l, r - l + 1);
+    return;
+  }
+  int km = (kl + kr) / 2;
+  SelectRange(A, l, r, ks[km]); // 先放好中间那个，左右两边的询问互不影响
+  MultiSelectRange(A, l, ks[km] - 1, ks, kl, km - 1);
+  MultiSelectRange(A, ks[km] + 1, r, ks, km + 1, kr);
+}
+
+void MultiSelect(ElemType A[], int n, const int ks[], int m) { // 一次放好多个位置
+  /**
+   * 结束后每个A[ks[i]]都是排序后在该位置的元素（ks从0开始，可以无序、可以重复）。
+   * 先放好中间的询问位置，再只对仍含有询问位置的两侧递归，没有询问的区间不再处理，
+   * 代价为O(nlogm)，比逐个调用NthElement的O(nm)少。
+   */
+  std::vector<int> sorted;
+  for (int i = 0; i < m; i++) // 不在[0,n)内的询问忽略
+    if (ks[i] >= 0 && ks[i] < n)
+      sorted.push_back(ks[i]);
+  m = (int)sorted.size();
+  if (m == 0)
+    return;
+  IntroSortLoop(sorted.data(), 0, m - 1, DepthLimit(m), Partition); // 询问位置也是int，与ElemType相同，O(mlogm)
+  int cnt = 0;
+  for (int i = 0; i < m; i++) // 去重
+    if (cnt == 0 || sorted[cnt - 1] != sorted[i])
+      sorted[cnt++] = sorted[i];
+  MultiSelectRange(A, 0, n - 1, sorted.data(), 0, cnt - 1);
+}
+
+static const int MERGE_RUN = 32; // 自底向上归并前，先用SmallSort排好的初始段长度
+
+static void MergeRuns(const ElemType src[], ElemType dst[], int l, int m,
+                      int r) { // 把src[l..m)和src[m..r)归并到dst[l..r)
+#ifdef SORT_HAVE_AVX2
+  MergeSortedInt(src + l, m - l, src + m, r - m, dst + l);
+#else
+  int i = l, j = m, k = l;
+  while (i < m && j < r) {
+    if (SORT_CMP(src[i] <= src[j])) // 相等时取左边，保持稳定
+      dst[k++] = src[i++];
+    else
+      dst[k++] = src[j++];
   }
-  printf("\n");
+  while (i < m)
+    dst[k++] = src[i++];
+  while (j < r)
+    dst[k++] = src[j++];
+  SORT_MOVES(r - l);
+#endif
+}
 
-  // Test HalfInsertSort (uses 1-based indexing with sentinel)
-  for (int i = 0; i <= n; i++) {
-    testArray[i] = original[i];
+void MergeSortBuffered(ElemType A[], int n,
+                       ElemType B[]) { // 非递归归并排序，B为调用者提供的辅助数组
+  /**
+   * Merge每次先把整段复制到辅助数组再归并回来，多一倍搬运。
+   * 这里辅助空间由调用者提供（至少n个元素），可以在多次调用间重复使用，排序过程中不再分配内存。
+   * 1. 先把A按MERGE_RUN分段，段内用SmallSort
+   * 2. 自底向上，每趟把长度为w的相邻两段归并成2w
+   * 3. 每趟在A和B之间交替作为源和目标（ping-pong），不必每趟都把结果复制回A，
+   *    只有趟数为奇数时最后复制一次
+   */
+  if (n < 2)
+    return;
+  for (int l = 0; l < n; l += MERGE_RUN)
+    SmallSort(A + l, l + MERGE_RUN < n ? MERGE_RUN : n - l);
+
+  ElemType *src = A, *dst = B;
+  for (int w = MERGE_RUN; w < n; w *= 2) {
+    for (int l = 0; l < n; l += 2 * w) {
+      int m = l + w < n ? l + w : n;
+      int r = l + 2 * w < n ? l + 2 * w : n;
+      MergeRuns(src, dst, l, m, r); // 落单的最后一段也要搬到dst
+    }
+    ElemType *tp = src;
+    src = dst;
+    dst = tp;
   }
-  HalfInsertSort(testArray, n);
-  printf(BOLD CYAN "=== Half Insert Sort Result ===" RESET "\n");
-  if (isSorted(&testArray[1], n)) { // Check sorting from index 1
-    printf(BOLD GREEN "✓ PASSED: Array is correctly sorted!" RESET "\n");
+  if (src != A)
+    copyArray(src, A, n);
+}
+
+static const int ADAPTIVE_MIN_RUN = 32; // 自然段短于该长度时用折半插入补足
+static const int MIN_GALLOP = 7;        // 一侧连续胜出这么多次后进入galloping模式
+
+static void BinaryInsertRun(ElemType A[], int l, int r,
+                            int start) { // A[l..start)已有序，把A[start..r)折半插入进去
+  for (int i = start; i < r; i++) {
+    ElemType tp = A[i];
+    int lo = l, hi = i;
+    while (lo < hi) { // 找第一个大于tp的位置，相等的元素插在后面，保持稳定
+      int mid = (lo + hi) / 2;
+      if (SORT_CMP(tp < A[mid]))
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    for (int j = i; j > lo; j--)
+      A[j] = A[j - 1];
+    A[lo] = tp;
+    SORT_MOVES(i - lo + 2);
+  }
+}
+
+static int CountRun(ElemType A[], int l, int n) { // 从l开始的自然段长度，严格降序段翻转成升序
+  if (l + 1 >= n)
+    return n - l;
+  int r = l + 2;
+  if (SORT_CMP(A[l + 1] < A[l])) { // 严格降序才能翻转，否则相等元素的次序会颠倒
+    while (r < n && SORT_CMP(A[r] < A[r - 1]))
+      r++;
+    for (int i = l, j = r - 1; i < j; i++, j--)
+      swap(A[i], A[j]);
   } else {
-    printf(BOLD RED "✗ FAILED: Array is NOT sorted correctly!" RESET "\n");
+    while (r < n && SORT_CMP(A[r] >= A[r - 1]))
+      r++;
   }
-  printf("\n");
+  return r - l;
+}
 
-  // Test ShellSort (convert to 0-based for this algorithm)
-  ElemType zeroBasedArray[20];
-  for (int i = 0; i < n; i++) {
-    zeroBasedArray[i] = original[i + 1]; // Skip sentinel
+static int Gallop(const ElemType A[], int len, ElemType key, bool upper,
+                  bool fromRight) { // 在有序的A[0..len)中找key的下界（upper时为上界）
+  /**
+   * 倍增查找：从一端开始按1,2,4,...跳，先确定结果所在的区间再二分。
+   * 结果离起点为d时只需O(logd)次比较，归并中一侧连续胜出很多次时比逐个比较快。
+   * before(x)表示x应排在结果位置之前：下界为x<key，上界为x<=key。
+   */
+  auto before = [&](ElemType x) { return SORT_CMP(upper ? !(key < x) : x < key); };
+  int lo, hi; // 结果在(lo, hi]中
+  if (!fromRight) {
+    int ofs = 1;
+    while (ofs <= len && before(A[ofs - 1]))
+      ofs *= 2;
+    lo = ofs / 2;
+    hi = ofs <= len ? ofs - 1 : len;
+    lo--; // A[ofs/2-1]已确定在前面
+  } else {
+    int ofs = 1;
+    while (ofs <= len && !before(A[len - ofs]))
+      ofs *= 2;
+    hi = len - ofs / 2;
+    lo = ofs <= len ? len - ofs : -1;
+  }
+  while (lo + 1 < hi) { // 不变式：A[lo]在前（或lo=-1），A[hi]不在前（或hi=len）
+    int mid = (lo + hi) / 2;
+    if (before(A[mid]))
+      lo = mid;
+    else
+      hi = mid;
   }
-  ShellSort(zeroBasedArray, n);
-  printArray(zeroBasedArray, n, "Shell Sort");
+  return hi;
+}
 
-  // Test BubbleSort (0-based)
-  for (int i = 0; i < n; i++) {
-    zeroBasedArray[i] = original[i + 1];
+static void MergeLo(ElemType A[], int l, int m, int r,
+                    ElemType buf[]) { // 左段较短：左段搬到buf，从前往后归并
+  int na = m - l, i = 0, j = m, k = l;
+  copyArray(A + l, buf, na);
+  int winA = 0, winB = 0;
+  while (i < na && j < r) {
+    if (SORT_CMP(A[j] < buf[i])) { // 相等时取左边，保持稳定
+      A[k++] = A[j++];
+      winB++, winA = 0;
+    } else {
+      A[k++] = buf[i++];
+      winA++, winB = 0;
+    }
+    SORT_MOVES(1);
+    if ((winA < MIN_GALLOP && winB < MIN_GALLOP) || i == na || j == r)
+      continue;
+    // galloping：直接找出一侧能连续输出多少个，整块搬过去
+    int c = 0, d = 0;
+    do {
+      c = Gallop(buf + i, na - i, A[j], true, false); // 左段中不大于A[j]的个数
+      copyArray(buf + i, A + k, c);
+      i += c, k += c;
+      if (i == na)
+        break;
+      A[k++] = A[j++];
+      SORT_MOVES(1);
+      if (j == r)
+        break;
+      d = Gallop(A + j, r - j, buf[i], false, false); // 右段中小于buf[i]的个数
+      memmove(A + k, A + j, d * sizeof(ElemType));
+      SORT_MOVES(d);
+      j += d, k += d;
+      if (j == r)
+        break;
+      A[k++] = buf[i++];
+      SORT_MOVES(1);
+      if (i == na)
+        break;
+    } while (c >= MIN_GALLOP || d >= MIN_GALLOP);
+    winA = winB = 0;
   }
-  BubbleSort(zeroBasedArray, n);
-  printArray(zeroBasedArray, n, "Bubble Sort");
+  copyArray(buf + i, A + k, na - i); // 右段剩下的已经在原位
+}
 
-  // Test QuickSort (0-based)
-  for (int i = 0; i < n; i++) {
-    zeroBasedArray[i] = original[i + 1];
+static void MergeHi(ElemType A[], int l, int m, int r,
+                    ElemType buf[]) { // 右段较短：右段搬到buf，从后往前归并
+  int nb = r - m, i = m - 1, j = nb - 1, k = r - 1;
+  copyArray(A + m, buf, nb);
+  int winA = 0, winB = 0;
+  while (i >= l && j >= 0) {
+    if (SORT_CMP(buf[j] < A[i])) { // 从后往前时相等取右边，保持稳定
+      A[k--] = A[i--];
+      winA++, winB = 0;
+    } else {
+      A[k--] = buf[j--];
+      winB++, winA = 0;
+    }
+    SORT_MOVES(1);
+    if ((winA < MIN_GALLOP && winB < MIN_GALLOP) || i < l || j < 0)
+      continue;
+    int c = 0, d = 0;
+    do {
+      c = (i + 1 - l) - Gallop(A + l, i + 1 - l, buf[j], true, true); // 左段中大于buf[j]的个数
+      k -= c, i -= c;
+      memmove(A + k + 1, A + i + 1, c * sizeof(ElemType));
+      SORT_MOVES(c);
+      if (i < l)
+        break;
+      A[k--] = buf[j--];
+      SORT_MOVES(1);
+      if (j < 0)
+        break;
+      d = (j + 1) - Gallop(buf, j + 1, A[i], false, true); // 右段中不小于A[i]的个数
+      k -= d, j -= d;
+      copyArray(buf + j + 1, A + k + 1, d);
+      if (j < 0)
+        break;
+      A[k--] = A[i--];
+      SORT_MOVES(1);
+      if (i < l)
+        break;
+    } while (c >= MIN_GALLOP || d >= MIN_GALLOP);
+    winA = winB = 0;
   }
-  QuickSort(zeroBasedArray, 0, n - 1);
-  printArray(zeroBasedArray, n, "Quick Sort");
+  copyArray(buf, A + l, j + 1); // 左段剩下的已经在原位
+}
 
-  // Test SelectSort (0-based)
-  for (int i = 0; i < n; i++) {
-    zeroBasedArray[i] = original[i + 1];
+static void MergeAdjacent(ElemType A[], int l, int m, int r,
+                          std::vector<ElemType> &buf) { // 归并相邻的有序段A[l..m)和A[m..r)
+  // 左段开头不大于A[m]的、右段末尾不小于A[m-1]的元素已经在最终位置
+  l += Gallop(A + l, m - l, A[m], true, false);
+  if (l == m)
+    return;
+  r = m + Gallop(A + m, r - m, A[m - 1], false, true);
+  int shorter = m - l < r - m ? m - l : r - m;
+  if ((int)buf.size() < shorter)
+    buf.resize(shorter);
+  if (m - l <= r - m)
+    MergeLo(A, l, m, r, buf.data());
+  else
+    MergeHi(A, l, m, r, buf.data());
+}
+
+static int NodePower(int s1, int n1, int n2, int n) { // powersort中两段交界处的结点深度
+  /**
+   * 把两段的中点a、b换算到[0,1)，它们二进制展开第一位不同的位置就是power。
+   * power越大，说明这个交界在归并树中越深，应该越早归并。
+   * 用2*s1+n1这样的整数代替中点，避免浮点运算。
+   */
+  long long a = 2LL * s1 + n1, b = a + n1 + n2;
+  int power = 0;
+  while (true) {
+    power++;
+    if (a >= n) { // 两个中点这一位都是1
+      a -= n;
+      b -= n;
+    } else if (b >= n) { // a这一位是0，b是1
+      break;
+    }
+    a <<= 1;
+    b <<= 1;
   }
-  SelectSort(zeroBasedArray, n);
-  printArray(zeroBasedArray, n, "Select Sort");
+  return power;
+}
+
+void AdaptiveSort(ElemType A[], int n) { // 自适应稳定排序（powersort），下标从0开始
+  /**
+   * 针对基本有序的输入：
+   * 1. 从左到右找自然段，升序段直接用，严格降序段翻转；
+   *    短于ADAPTIVE_MIN_RUN的段用折半插入补足
+   * 2. 段放入栈中，按powersort的规则决定何时归并：新交界的power比栈顶的小时，
+   *    先把栈顶更深的交界归并掉。这样得到的归并树接近按段长最优
+   * 3. 归并前先倍增查找去掉两端已经就位的元素，只把较短的一段搬到辅助数组；
+   *    一侧连续胜出时改为galloping整块搬移
+   * 整体有序时只扫描一遍，O(n)；段数为r时为O(n logr)，最坏O(nlogn)。
+   */
+  if (n < 2)
+    return;
+  struct Run {
+    int base, len, power; // power为该段与下一段交界的深度
+  };
+  std::vector<Run> stack;
+  std::vector<ElemType> buf; // 按需扩大，整体有序时不分配
 
-  // Test MergeSort (0-based)
+  auto nextRun = [&](int l) {
+    int len = CountRun(A, l, n);
+    if (len < ADAPTIVE_MIN_RUN && l + len < n) {
+      int end = l + ADAPTIVE_MIN_RUN < n ? l + ADAPTIVE_MIN_RUN : n;
+      BinaryInsertRun(A, l, end, l + len);
+      len = end - l;
+    }
+    return Run{l, len, 0};
+  };
+
+  Run cur = nextRun(0);
+  while (cur.base + cur.len < n) {
+    Run next = nextRun(cur.base + cur.len);
+    int p = NodePower(cur.base, cur.len, next.len, n);
+    while (!stack.empty() && stack.back().power > p) {
+      Run top = stack.back();
+      stack.pop_back();
+      MergeAdjacent(A, top.base, cur.base, cur.base + cur.len, buf);
+      cur = Run{top.base, top.len + cur.len, 0};
+    }
+    cur.power = p;
+    stack.push_back(cur);
+    cur = next;
+  }
+  while (!stack.empty()) {
+    Run top = stack.back();
+    stack.pop_back();
+    MergeAdjacent(A, top.base, cur.base, cur.base + cur.len, buf);
+    cur = Run{top.base, top.len + cur.len, 0};
+  }
+}
+
+static const int RADIX_BITS = 8;                // 每趟处理的位数
+static const int RADIX = 1 << RADIX_BITS;        // 桶数
+static const int RADIX_PASSES = sizeof(ElemType) * 8 / RADIX_BITS;
+static const int RADIX_PREFETCH = 16;             // 分配时提前预取的元素数
+
+static inline unsigned int RadixKey(ElemType x) { // 翻转符号位，负数按无符号比较时就排在正数前面
+  return (unsigned int)x ^ 0x80000000u;
+}
+
+static inline int RadixDigit(ElemType x, int shift) {
+  return (RadixKey(x) >> shift) & (RADIX - 1);
+}
+
+void RadixSort(ElemType A[], int n, ElemType B[]) { // LSD基数排序，B为调用者提供的辅助数组
+  /**
+   * 按8位一趟，从低位到高位做4趟稳定的计数分配。
+   * 1. 先扫描一遍同时统计4趟的直方图，之后每趟只需做前缀和和分配
+   * 2. 分配在A和B之间交替进行，只用一块辅助数组
+   * 3. 若某趟所有元素该位都相同，则跳过这一趟
+   * 4. 分配是往256个位置交替写，硬件预取跟不上，写之前按稍后元素的桶位置软件预取；
+   *    统计直方图是顺序读，硬件预取已足够，不再加预取
+   */
+  if (n < 2)
+    return;
+  int count[RADIX_PASSES][RADIX] = {{0}};
   for (int i = 0; i < n; i++) {
-    zeroBasedArray[i] = original[i + 1];
+    unsigned int k = RadixKey(A[i]);
+    for (int p = 0; p < RADIX_PASSES; p++)
+      count[p][(k >> (p * RADIX_BITS)) & (RADIX - 1)]++;
   }
-  MergeSort(zeroBasedArray, 0, n - 1);
-  printArray(zeroBasedArray, n, "Merge Sort");
 
-  // Test HeapSort (already uses 1-based indexing)
-  ElemType heapArray[21]; // size n+1 for heap sort
-  heapArray[0] = 0;       // dummy element for heap
-  for (int i = 1; i <= n; i++) {
-    heapArray[i] = original[i];
+  ElemType *src = A, *dst = B;
+  for (int p = 0; p < RADIX_PASSES; p++) {
+    int shift = p * RADIX_BITS;
+    if (count[p][RadixDigit(A[0], shift)] == n) // 这一位全部相同，分配后顺序不变
+      continue;
+    int pos[RADIX];
+    for (int d = 0, sum = 0; d < RADIX; d++) { // 前缀和得到每个桶的起始位置
+      pos[d] = sum;
+      sum += count[p][d];
+    }
+    int i = 0;
+    for (; i < n - RADIX_PREFETCH; i++) { // 提前预取RADIX_PREFETCH个元素之后要写的位置
+      __builtin_prefetch(&dst[pos[RadixDigit(src[i + RADIX_PREFETCH], shift)]], 1);
+      dst[pos[RadixDigit(src[i], shift)]++] = src[i];
+    }
+    for (; i < n; i++)
+      dst[pos[RadixDigit(src[i], shift)]++] = src[i];
+    SORT_MOVES(n);
+    ElemType *tp = src;
+    src = dst;
+    dst = tp;
   }
-  HeapSort(heapArray, n);
-  printf(BOLD CYAN "=== Heap Sort Result ===" RESET "\n");
-  if (isSorted(&heapArray[1], n)) { // Check sorting from index 1
-    printf(BOLD GREEN "✓ PASSED: Array is correctly sorted!" RESET "\n");
-  } else {
-    printf(BOLD RED "✗ FAILED: Array is NOT sorted correctly!" RESET "\n");
+  if (src != A)
+    copyArray(src, A, n);
+}
+
+static void AmericanFlagSort(ElemType A[], int l, int r, int shift) { // 对A[l..r)按shift位起的8位原地分桶
+  if (r - l <= SMALL_SORT_NET) { // 小桶直接用排序网络
+    SmallSort(A + l, r - l);
+    return;
+  }
+  int count[RADIX] = {0};
+  for (int i = l; i < r; i++)
+    count[RadixDigit(A[i], shift)]++;
+  int head[RADIX], tail[RADIX];
+  for (int d = 0, sum = l; d < RADIX; d++) {
+    head[d] = sum;
+    sum += count[d];
+    tail[d] = sum;
+  }
+  for (int b = 0; b < RADIX; b++) { // 逐个桶填满：拿出元素放到它该去的桶，再拿出被占位置上的元素，直到转回本桶
+    while (head[b] < tail[b]) {
+      ElemType v = A[head[b]];
+      int d = RadixDigit(v, shift);
+      while (d != b) {
+        swap(v, A[head[d]++]);
+        d = RadixDigit(v, shift);
+      }
+      A[head[b]++] = v;
+      SORT_MOVES(2);
+    }
+  }
+  if (shift == 0)
+    return;
+  for (int d = 0, start = l; d < RADIX; d++) { // 各桶再按下一个8位递归
+    if (count[d] > 1)
+      AmericanFlagSort(A, start, start + count[d], shift - RADIX_BITS);
+    start += count[d];
+  }
+}
+
+void RadixSortInPlace(ElemType A[], int n) { // MSD基数排序（American flag sort），不需要辅助数组
+  /**
+   * 从最高8位开始，统计各桶大小后在原数组内循环交换把元素放入所在桶，
+   * 再对每个桶递归处理下一个8位，递归深度最多4层，不稳定。
+   */
+  if (n < 2)
+    return;
+  AmericanFlagSort(A, 0, n, (RADIX_PASSES - 1) * RADIX_BITS);
+}
+
+void ParallelRadixSort(ElemType A[], int n, ElemType B[],
+                       int threads) { // 并行LSD基数排序
+  /**
+   * 把数组均分成threads段，每趟：
+   * 1. 各线程统计自己那一段的直方图
+   * 2. 按(桶, 线程)的顺序求前缀和，得到每个线程在每个桶里的写入起点
+   * 3. 各线程把自己那一段分配到dst，写入区域互不重叠，结果仍然稳定
+   */
+  if (threads <= 0)
+    threads = std::thread::hardware_concurrency();
+  if (threads <= 1 || n < threads * RADIX * 16) {
+    RadixSort(A, n, B);
+    return;
+  }
+
+  std::vector<int> hist(threads * RADIX);
+  int chunk = (n + threads - 1) / threads;
+  ElemType *src = A, *dst = B;
+  for (int p = 0; p < RADIX_PASSES; p++) {
+    int shift = p * RADIX_BITS;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+      workers.push_back(std::thread([&, t]() { // 统计
+        int *h = &hist[t * RADIX];
+        int l = t * chunk, r = l + chunk < n ? l + chunk : n;
+        for (int d = 0; d < RADIX; d++)
+          h[d] = 0;
+        for (int i = l; i < r; i++)
+          h[RadixDigit(src[i], shift)]++;
+      }));
+    }
+    for (int t = 0; t < threads; t++)
+      workers[t].join();
+
+    int digit = RadixDigit(src[0], shift), same = 0;
+    for (int t = 0; t < threads; t++)
+      same += hist[t * RADIX + digit];
+    if (same == n) // 这一位全部相同
+      continue;
+    for (int d = 0, sum = 0; d < RADIX; d++) { // 直方图就地改写为写入起点
+      for (int t = 0; t < threads; t++) {
+        int c = hist[t * RADIX + d];
+        hist[t * RADIX + d] = sum;
+        sum += c;
+      }
+    }
+
+    workers.clear();
+    for (int t = 0; t < threads; t++) {
+      workers.push_back(std::thread([&, t]() { // 分配
+        int *pos = &hist[t * RADIX];
+        int l = t * chunk, r = l + chunk < n ? l + chunk : n;
+        int i = l;
+        for (; i < r - RADIX_PREFETCH; i++) { // 同RadixSort，预取之后要写的位置
+          __builtin_prefetch(&dst[pos[RadixDigit(src[i + RADIX_PREFETCH], shift)]], 1);
+          dst[pos[RadixDigit(src[i], shift)]++] = src[i];
+        }
+        for (; i < r; i++)
+          dst[pos[RadixDigit(src[i], shift)]++] = src[i];
+        SORT_MOVES(r - l);
+      }));
+    }
+    for (int t = 0; t < threads; t++)
+      workers[t].join();
+    ElemType *tp = src;
+    src = dst;
+    dst = tp;
+  }
+  if (src != A)
+    copyArray(src, A, n);
+}
+
+static const int SAMPLE_LOG_BUCKETS = 7;                      // 样本排序分2^7个区间
+static const int SAMPLE_BUCKETS = 1 << SAMPLE_LOG_BUCKETS;
+static const int SAMPLE_OVERSAMPLE = 16;                      // 每个区间抽样的元素数
+static const int SAMPLE_WC = 16;                              // 写合并缓冲的元素数（64字节）
+
+static void BuildSplitterTree(const ElemType s[], ElemType tree[], int node,
+                              int l, int r) { // 把有序的s[l..r)按完全二叉树（下标从1开始）存入tree
+  if (l >= r)
+    return;
+  int mid = (l + r) / 2;
+  tree[node] = s[mid];
+  BuildSplitterTree(s, tree, 2 * node, l, mid);
+  BuildSplitterTree(s, tree, 2 * node + 1, mid + 1, r);
+}
+
+static inline int SampleBucket(const ElemType tree[], const ElemType s[],
+                               ElemType x) { // 返回x所属的桶，奇数为等值桶
+  int i = 1;
+  for (int d = 0; d < SAMPLE_LOG_BUCKETS; d++) // 无分支：比较结果直接作为下标的最低位
+    i = 2 * i + SORT_CMP(tree[i] < x);
+  int b = i - SAMPLE_BUCKETS; // 小于x的分隔元素个数，s[b-1] < x <= s[b]
+  return 2 * b + SORT_CMP(x == s[b]);
+}
+
+void ParallelSampleSort(ElemType A[], int n, ElemType B[],
+                        int threads) { // 并行稳定样本排序，B为调用者提供的辅助数组
+  /**
+   * 1. 随机抽取SAMPLE_BUCKETS*SAMPLE_OVERSAMPLE个样本排序，等距取出分隔元素。
+   *    过采样使各桶大小接近n/SAMPLE_BUCKETS
+   * 2. 分隔元素按完全二叉树存放，每个元素走log(桶数)层，每层一次比较，没有分支。
+   *    等于分隔元素的单独放入等值桶，重复值很多时不会全挤进一个桶，等值桶也不必再排序
+   * 3. 数组均分成threads段，各段分类并统计直方图，按(桶, 线程)的顺序求前缀和，
+   *    各线程把自己那一段分配到B。桶内按线程、线程内按原顺序，所以是稳定的
+   * 4. 分配时每个桶先攒满一个缓存行再整块写出（写合并），减少对上百个位置的零散写
+   * 5. 各桶互不相干，按从大到小分给线程用MergeSortBuffered排序，A中对应区域作辅助数组，
+   *    排好后复制回A
+   */
+  if (threads <= 0)
+    threads = std::thread::hardware_concurrency();
+  if (threads <= 1 || n < SAMPLE_BUCKETS * SAMPLE_OVERSAMPLE * 64) {
+    MergeSortBuffered(A, n, B);
+    return;
+  }
+
+  // 抽样并选出分隔元素，补到SAMPLE_BUCKETS个，多出的重复最后一个，这样x==s[b]对最后一个桶恒不成立
+  int m = SAMPLE_BUCKETS * SAMPLE_OVERSAMPLE;
+  std::vector<ElemType> sample(m);
+  unsigned long long rnd = 88172645463325252ULL ^ (unsigned long long)n;
+  for (int i = 0; i < m; i++) {
+    rnd ^= rnd << 13;
+    rnd ^= rnd >> 7;
+    rnd ^= rnd << 17;
+    sample[i] = A[rnd % n];
+  }
+  IntroSortLoop(sample.data(), 0, m - 1, DepthLimit(m), Partition);
+  ElemType s[SAMPLE_BUCKETS], tree[SAMPLE_BUCKETS];
+  for (int i = 0; i < SAMPLE_BUCKETS - 1; i++)
+    s[i] = sample[(i + 1) * SAMPLE_OVERSAMPLE - 1];
+  s[SAMPLE_BUCKETS - 1] = s[SAMPLE_BUCKETS - 2];
+  BuildSplitterTree(s, tree, 1, 0, SAMPLE_BUCKETS - 1);
+
+  const int NB = 2 * SAMPLE_BUCKETS; // 普通桶和等值桶交替
+  std::vector<unsigned char> ids(n); // 分类结果，分配时不必再查一遍树
+  std::vector<int> hist(threads * NB);
+  int chunk = (n + threads - 1) / threads;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.push_back(std::thread([&, t]() { // 分类
+      int *h = &hist[t * NB];
+      int l = t * chunk, r = l + chunk < n ? l + chunk : n;
+      for (int i = l; i < r; i++) {
+        int b = SampleBucket(tree, s, A[i]);
+        ids[i] = (unsigned char)b;
+        h[b]++;
+      }
+    }));
+  }
+  for (int t = 0; t < threads; t++)
+    workers[t].join();
+
+  int start[NB + 1]; // 每个桶在B中的起点
+  for (int b = 0, sum = 0; b < NB; b++) {
+    start[b] = sum;
+    for (int t = 0; t < threads; t++) { // 直方图就地改写为写入起点
+      int c = hist[t * NB + b];
+      hist[t * NB + b] = sum;
+      sum += c;
+    }
+    start[b + 1] = sum;
+  }
+
+  workers.clear();
+  for (int t = 0; t < threads; t++) {
+    workers.push_back(std::thread([&, t]() { // 经写合并缓冲分配
+      int *pos = &hist[t * NB];
+      std::vector<ElemType> wc(NB * SAMPLE_WC);
+      int fill[NB] = {0};
+      int l = t * chunk, r = l + chunk < n ? l + chunk : n;
+      for (int i = l; i < r; i++) {
+        int b = ids[i];
+        wc[b * SAMPLE_WC + fill[b]++] = A[i];
+        SORT_MOVES(1);
+        if (fill[b] == SAMPLE_WC) {
+          copyArray(&wc[b * SAMPLE_WC], B + pos[b], SAMPLE_WC);
+          pos[b] += SAMPLE_WC;
+          fill[b] = 0;
+        }
+      }
+      for (int b = 0; b < NB; b++)
+        copyArray(&wc[b * SAMPLE_WC], B + pos[b], fill[b]);
+    }));
+  }
+  for (int t = 0; t < threads; t++)
+    workers[t].join();
+
+  int order[NB]; // 大桶先排，线程间负载更均衡
+  for (int b = 0; b < NB; b++) { // 按桶大小从大到小插入排序
+    int len = start[b + 1] - start[b], j = b;
+    for (; j > 0 && start[order[j - 1] + 1] - start[order[j - 1]] < len; j--)
+      order[j] = order[j - 1];
+    order[j] = b;
+  }
+  std::atomic<int> next(0);
+  workers.clear();
+  for (int t = 0; t < threads; t++) {
+    workers.push_back(std::thread([&]() { // 桶内排序并复制回A
+      for (int j = next++; j < NB; j = next++) {
+        int b = order[j], l = start[b], len = start[b + 1] - l;
+        if (b % 2 == 0) // 奇数号的等值桶元素全部相等，不用排
+          MergeSortBuffered(B + l, len, A + l);
+        copyArray(B + l, A + l, len);
+      }
+    }));
   }
-  printf("\n");
+  for (int t = 0; t < threads; t++)
+    workers[t].join();
+}
 
-  // Test Bubble2Sort (0-based)
+void ArgSort(const ElemType keys[], int n, int idx[]) { // 间接排序：idx[i]为第i小的key的下标，稳定
+  /**
+   * 把(变换后的key, 下标)拼成一个64位整数，对高32位做LSD基数排序。
+   * 拼在一起后每趟分配只读一个数组，不必按下标跳着访问keys；
+   * 低32位的下标一开始就是升序的，LSD分配是稳定的，所以相等的key保持原有次序。
+   */
+  if (n <= 0)
+    return;
+  std::vector<unsigned long long> P(n), Q(n);
+  int count[RADIX_PASSES][RADIX] = {{0}};
   for (int i = 0; i < n; i++) {
-    zeroBasedArray[i] = original[i + 1];
+    unsigned int k = RadixKey(keys[i]);
+    P[i] = (unsigned long long)k << 32 | (unsigned int)i;
+    for (int p = 0; p < RADIX_PASSES; p++)
+      count[p][(k >> (p * RADIX_BITS)) & (RADIX - 1)]++;
   }
-  Bubble2Sort(zeroBasedArray, n);
-  printArray(zeroBasedArray, n, "Bidirectional Bubble Sort");
 
-  printf(BOLD MAGENTA "============== TEST COMPLETE ==============" RESET "\n");
+  unsigned long long *src = P.data(), *dst = Q.data();
+  for (int p = 0; p < RADIX_PASSES; p++) {
+    int shift = 32 + p * RADIX_BITS;
+    if (count[p][(src[0] >> shift) & (RADIX - 1)] == n) // 这一位全部相同
+      continue;
+    int pos[RADIX];
+    for (int d = 0, sum = 0; d < RADIX; d++) {
+      pos[d] = sum;
+      sum += count[p][d];
+    }
+    for (int i = 0; i < n; i++)
+      dst[pos[(src[i] >> shift) & (RADIX - 1)]++] = src[i];
+    unsigned long long *tp = src;
+    src = dst;
+    dst = tp;
+  }
+  for (int i = 0; i < n; i++)
+    idx[i] = (int)(src[i] & 0xffffffffu);
 }
 
-// Enhanced print function that shows array details
-void printArrayDetailed(ElemType A[], int n, const char *sortName,
-                        bool isOneBased = false) {
-  printf(BOLD CYAN "=== %s Result ===" RESET "\n", sortName);
+void ApplyPermutation(void *data, size_t size, int idx[],
+                      int n) { // 原地重排：新的第i个记录为原来的第idx[i]个
+  /**
+   * 按置换的环来搬：环的第一个记录先存到tp，然后沿着环把后继的记录依次往前搬，
+   * 最后把tp放到环的末尾。每个记录只搬一次，额外空间只有一个记录。
+   * 处理过的位置把idx[j]取反做标记，全部处理完再恢复，所以idx不变。
+   */
+  char *base = (char *)data;
+  std::vector<char> tp(size);
+  for (int i = 0; i < n; i++) {
+    if (idx[i] < 0 || idx[i] == i) // 已处理或不用动
+      continue;
+    memcpy(tp.data(), base + (size_t)i * size, size);
+    int j = i;
+    while (idx[j] != i) {
+      int k = idx[j];
+      __builtin_prefetch(base + (size_t)idx[k] * size); // 环上的访问是随机的，提前取下一个记录
+      memcpy(base + (size_t)j * size, base + (size_t)k * size, size);
+      SORT_MOVES(1);
+      idx[j] = ~k;
+      j = k;
+    }
+    memcpy(base + (size_t)j * size, tp.data(), size);
+    SORT_MOVES(2);
+    idx[j] = ~i;
+  }
+  for (int i = 0; i < n; i++)
+    if (idx[i] < 0)
+      idx[i] = ~idx[i];
+}
 
-  // Print array elements
-  printf("Array: ");
-  int start = isOneBased ? 1 : 0;
-  int end = isOneBased ? n : n - 1;
+void SortByKey(ElemType keys[], void *payload, int n,
+               size_t payloadSize) { // 按keys排序，payload的第i个记录跟着keys[i]走，稳定
+  /**
+   * 先只对key求出次序，再按这个次序原地重排keys和payload。
+   * 排序过程中大记录一次都不动，最后每个记录恰好搬一次。
+   */
+  if (n < 2)
+    return;
+  std::vector<int> idx(n);
+  ArgSort(keys, n, idx.data());
+  ApplyPermutation(keys, sizeof(ElemType), idx.data(), n);
+  if (payload != NULL && payloadSize > 0)
+    ApplyPermutation(payload, payloadSize, idx.data(), n);
+}
 
-  for (int i = start; i <= end; i++) {
-    if (i > start && A[i] < A[i - 1]) {
-      printf(RED "%d " RESET, A[i]); // Red for incorrect order
-    } else {
-      printf(GREEN "%d " RESET, A[i]); // Green for correct order
+static const int EXT_MIN_BUF = 4096; // 外部排序每路缓冲区的最少元素数
+
+typedef struct {      // 归并段的顺序读入缓冲
+  FILE *f;
+  ElemType *buf;
+  int cap, len, pos;  // 缓冲区容量、有效长度、读指针
+  bool done;          // 该段已读完
+  long long *bytes;   // 累计读入字节数
+} RunReader;
+
+typedef struct {      // 顺序写出缓冲
+  FILE *f;
+  ElemType *buf;
+  int cap, len;
+  long long *bytes;   // 累计写出字节数
+  bool ok;
+} RunWriter;
+
+static void ReaderFill(RunReader &R) {
+  R.len = fread(R.buf, sizeof(ElemType), R.cap, R.f);
+  R.pos = 0;
+  *R.bytes += (long long)R.len * sizeof(ElemType);
+  if (R.len == 0)
+    R.done = true;
+}
+
+static void WriterFlush(RunWriter &W) {
+  if (W.len > 0 && fwrite(W.buf, sizeof(ElemType), W.len, W.f) != (size_t)W.len)
+    W.ok = false;
+  *W.bytes += (long long)W.len * sizeof(ElemType);
+  W.len = 0;
+}
+
+static inline void WriterPut(RunWriter &W, ElemType x) {
+  W.buf[W.len++] = x;
+  if (W.len == W.cap)
+    WriterFlush(W);
+}
+
+static inline bool LoserBeats(RunReader R[], int a, int b) { // a段当前元素是否应先输出，读完的段视为无穷大
+  if (R[a].done)
+    return false;
+  if (R[b].done)
+    return true;
+  return R[a].buf[R[a].pos] < R[b].buf[R[b].pos];
+}
+
+static void LoserAdjust(int ls[], RunReader R[], int k, int s) { // 从叶子s向根调整败者树
+  for (int t = (s + k) / 2; t > 0; t /= 2) {
+    if (ls[t] == -1) { // 建树时结点为空，先占住，等另一棵子树的胜者上来再比
+      ls[t] = s;
+      return;
+    }
+    if (LoserBeats(R, ls[t], s)) { // 败者留在结点，胜者继续向上
+      int tp = ls[t];
+      ls[t] = s;
+      s = tp;
     }
   }
-  printf("\n");
+  ls[0] = s; // 最终胜者
+}
 
-  // Check if sorted correctly
-  ElemType *checkArray = isOneBased ? &A[1] : A;
-  int checkSize = isOneBased ? n : n;
+static bool MergeRunFiles(FILE *in[], int k, FILE *out, ElemType *mem,
+                          int memElems, long long &bytesRead,
+                          long long &bytesWritten) { // 用败者树把k个归并段合并写到out
+  /**
+   * 内存均分成k+1块：k块作为各段的输入缓冲，1块作为输出缓冲
+   * ls[1..k-1]记录各内部结点的败者，ls[0]是当前最小元素所在的段，
+   * 每输出一个元素只需沿一条路径调整，比较次数为logk
+   */
+  int bufElems = memElems / (k + 1);
+  std::vector<RunReader> R(k);
+  std::vector<int> ls(k, -1);
+  for (int i = 0; i < k; i++) {
+    R[i].f = in[i];
+    R[i].buf = mem + i * bufElems;
+    R[i].cap = bufElems;
+    R[i].done = false;
+    R[i].bytes = &bytesRead;
+    ReaderFill(R[i]);
+  }
+  RunWriter W = {out, mem + k * bufElems, bufElems, 0, &bytesWritten, true};
 
-  if (isSorted(checkArray, checkSize)) {
-    printf(BOLD GREEN "✓ PASSED: Array is correctly sorted!" RESET "\n");
-  } else {
-    printf(BOLD RED "✗ FAILED: Array is NOT sorted correctly!" RESET "\n");
+  for (int i = k - 1; i >= 0; i--)
+    LoserAdjust(ls.data(), R.data(), k, i);
+  while (!R[ls[0]].done) {
+    RunReader &win = R[ls[0]];
+    WriterPut(W, win.buf[win.pos++]);
+    if (win.pos == win.len)
+      ReaderFill(win);
+    LoserAdjust(ls.data(), R.data(), k, ls[0]);
   }
-  printf("\n");
+  WriterFlush(W);
+  for (int i = 0; i < k; i++)
+    if (ferror(in[i]))
+      return false;
+  return W.ok;
 }
 
-int main() {
-  testAllSorts();
-  return 0;
-}
\ No newline at end of file
+bool ExternalSort(const char *inputPath, const char *outputPath,
+                  size_t memBudget, ExternalSortStats *stats,
+                  bool async) { // 外部排序，文件内容为ElemType的二进制序列
+  /**
+   * 1. 生成初始归并段：每次读入内存预算能放下的元素，用RadixSortInPlace排好后写入临时文件
+   *    async为true时内存分两半，后台线程写出上一段的同时读入并排序下一段
+   * 2. 多路归并：每趟最多合并 预算/EXT_MIN_BUF-1 路，用败者树选最小，直到只剩一个段
+   *    最后一趟直接写到outputPath
+   * 临时文件用tmpfile()创建，关闭即删除。stats非空时记录每趟读写的字节数。
+   * 出错返回false。
+   */
+  ExternalSortStats local;
+  if (stats == NULL)
+    stats = &local;
+  stats->passes = 0;
+
+  FILE *in = fopen(inputPath, "rb");
+  if (in == NULL)
+    return false;
+  size_t budgetElems = memBudget / sizeof(ElemType); // 先在size_t中计算，超过8GB的预算不会截断
+  if (budgetElems > (size_t)INT_MAX)
+    budgetElems = INT_MAX;
+  if (fseek(in, 0, SEEK_END) == 0) { // 预算超过输入所需时只按输入大小分配（异步时两块缓冲各装得下全部输入）
+    long size = ftell(in);
+    if (size >= 0 && (size_t)size / sizeof(ElemType) * 2 < budgetElems)
+      budgetElems = (size_t)size / sizeof(ElemType) * 2;
+  }
+  rewind(in);
+  int memElems = (int)budgetElems;
+  if (memElems < 4 * EXT_MIN_BUF)
+    memElems = 4 * EXT_MIN_BUF;
+  std::vector<ElemType> mem(memElems);
+
+  // 第一趟：生成初始归并段
+  std::vector<FILE *> runs;
+  long long readBytes = 0, writeBytes = 0;
+  int chunk = async ? memElems / 2 : memElems;
+  bool ok = true, writeOk = true; // writeOk只由写线程修改，join之后再汇总
+  std::thread writer;
+  for (int cur = 0;; cur ^= 1) {
+    ElemType *buf = mem.data() + (async ? cur * chunk : 0);
+    int len = fread(buf, sizeof(ElemType), chunk, in);
+    readBytes += (long long)len * sizeof(ElemType);
+    if (len == 0)
+      break;
+    RadixSortInPlace(buf, len);
+    FILE *run = tmpfile();
+    if (run == NULL) {
+      ok = false;
+      break;
+    }
+    runs.push_back(run);
+    writeBytes += (long long)len * sizeof(ElemType);
+    if (writer.joinable())
+      writer.join();
+    if (async) {
+      writer = std::thread([run, buf, len, &writeOk]() {
+        if (fwrite(buf, sizeof(ElemType), len, run) != (size_t)len)
+          writeOk = false;
+      });
+    } else if (fwrite(buf, sizeof(ElemType), len, run) != (size_t)len) {
+      writeOk = false;
+    }
+  }
+  if (writer.joinable())
+    writer.join();
+  if (ferror(in) || !writeOk)
+    ok = false;
+  fclose(in);
+  stats->bytesRead[0] = readBytes;
+  stats->bytesWritten[0] = writeBytes;
+  stats->passes = 1;
+
+  // 之后每趟：多路归并
+  int fanIn = memElems / EXT_MIN_BUF - 1;
+  while (ok) {
+    FILE *out;
+    bool last = runs.size() <= (size_t)fanIn;
+    if (last)
+      out = fopen(outputPath, "wb");
+    else
+      out = tmpfile();
+    if (out == NULL) {
+      ok = false;
+      break;
+    }
+    long long r = 0, w = 0;
+    std::vector<FILE *> next;
+    for (size_t i = 0; ok && (i < runs.size() || (i == 0 && last)); i += fanIn) {
+      int k = runs.size() - i < (size_t)fanIn ? runs.size() - i : fanIn;
+      FILE *dst = out;
+      if (!last && i > 0) { // 本趟产生的第2个及以后的段
+        dst = tmpfile();
+        if (dst == NULL) {
+          ok = false;
+          break;
+        }
+      }
+      for (int j = 0; j < k; j++)
+        rewind(runs[i + j]);
+      if (k > 0)
+        ok = MergeRunFiles(&runs[i], k, dst, mem.data(), memElems, r, w) && ok;
+      if (!last)
+        next.push_back(dst);
+    }
+    for (size_t i = 0; i < runs.size(); i++)
+      fclose(runs[i]);
+    runs = next;
+    if (stats->passes < EXT_MAX_PASSES) {
+      stats->bytesRead[stats->passes] = r;
+      stats->bytesWritten[stats->passes] = w;
+    }
+    stats->passes++;
+    if (last) {
+      if (fclose(out) != 0)
+        ok = false;
+      break;
+    }
+  }
+  for (size_t i = 0; i < runs.size(); i++)
+    fclose(runs[i]);
+  return ok;
+}
+
+// 排序统计
+
+#ifdef __linux__
+static int PerfOpen(unsigned int type,
+                    unsigned long long config) { // 打开一个只统计用户态的计数器，失败返回-1
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.inherit = 1; // 统计期间创建的工作线程也计入
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+static long long NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void SortStatsBegin(SortStats &st) { // 清零计数并开始统计
+  /**
+   * 比较/赋值次数来自SORT_CMP/SORT_MOVES插桩，计数器是全局的，
+   * 同一时间只能有一组Begin/End在统计。
+   * 硬件计数器用perf_event_open打开，在没有PMU的虚拟机、容器或
+   * perf_event_paranoid不允许时打开失败，对应字段为-1，其余统计照常。
+   */
+  st.comparisons = st.moves = -1;
+  st.cycles = st.instructions = st.branchMisses = st.llcMisses = -1;
+  st.ns = 0;
+#ifdef SORT_INSTRUMENT
+  sortComparisons = 0;
+  sortMoves = 0;
+#endif
+  for (int c = 0; c < SORT_PERF_COUNTERS; c++)
+    st.perfFd[c] = -1;
+#ifdef __linux__
+  static const unsigned int TYPES[SORT_PERF_COUNTERS] = {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+      PERF_TYPE_HW_CACHE};
+  static const unsigned long long CONFIGS[SORT_PERF_COUNTERS] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_BRANCH_MISSES,
+      PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+  for (int c = 0; c < SORT_PERF_COUNTERS; c++)
+    st.perfFd[c] = PerfOpen(TYPES[c], CONFIGS[c]);
+  for (int c = 0; c < SORT_PERF_COUNTERS; c++) // 全部打开后再一起启动，减少开销计入
+    if (st.perfFd[c] >= 0)
+      ioctl(st.perfFd[c], PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  st.startNs = NowNs();
+}
+
+void SortStatsEnd(SortStats &st) { // 停止统计并填好各字段
+  st.ns = (double)(NowNs() - st.startNs);
+#ifdef __linux__
+  long long *fields[SORT_PERF_COUNTERS] = {&st.cycles, &st.instructions,
+                                           &st.branchMisses, &st.llcMisses};
+  for (int c = 0; c < SORT_PERF_COUNTERS; c++) {
+    if (st.perfFd[c] < 0)
+      continue;
+    ioctl(st.perfFd[c], PERF_EVENT_IOC_DISABLE, 0);
+    long long value;
+    if (read(st.perfFd[c], &value, sizeof(value)) == (ssize_t)sizeof(value))
+      *fields[c] = value;
+    close(st.perfFd[c]);
+    st.perfFd[c] = -1;
+  }
+#endif
+#ifdef SORT_INSTRUMENT
+  st.comparisons = sortComparisons;
+  st.moves = sortMoves;
+#endif
+}
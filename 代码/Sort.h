@@ -0,0 +1,121 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include "stdafx.h"
+
+// Function declarations
+
+// Utility functions
+void copyArray(ElemType src[], ElemType dest[], int n);
+void swap(ElemType &a, ElemType &b);
+bool isSorted(ElemType A[], int n);
+
+// Insertion sorts (1-based, A[0] is sentinel)
+void InsertSort(ElemType A[], int n);
+void HalfInsertSort(ElemType A[], int n);
+void ShellSort(ElemType A[], int n);
+
+// Exchange sorts
+void BubbleSort(ElemType A[], int n);
+int Partition(ElemType A[], int l, int r);
+void QuickSort(ElemType A[], int l, int r);
+
+// Selection sorts
+void SelectSort(ElemType A[], int n);
+void HeadAdjust(ElemType A[], int k, int n);
+void BuildMaxHeap(ElemType A[], int n);
+void HeapSort(ElemType A[], int n);       // 1-based, 4-ary heap
+void BinaryHeapSort(ElemType A[], int n); // 1-based, textbook binary heap
+
+// Merge sort
+void Merge(ElemType A[], int l, int m, int r);
+void MergeSort(ElemType A[], int l, int r);
+
+// 8.3 exercises
+void Bubble2Sort(ElemType A[], int n);
+void QuickMove(ElemType A[], int n);
+void QuickSort2(ElemType A[], int low, int high);
+ElemType KthElement(ElemType A[], int low, int high, int k);
+ElemType FlagArrange(ElemType A[], int n);
+ElemType SetSlice(ElemType A[], int n);
+
+// Production sorts
+typedef int (*PartitionFunc)(ElemType A[], int l, int r); // Partition contract
+
+int BlockPartition(ElemType A[], int l, int r); // drop-in for Partition
+void SmallSort(ElemType A[], int n); // 0-based, AVX2 network for n <= 64
+void IntroSort(ElemType A[], int n, // 1-based, A[0] is unused
+               PartitionFunc partition = Partition);
+void ParallelQuickSort(ElemType A[], int n, int threads = 0, // 1-based
+                       PartitionFunc partition = Partition);
+void FlagPartition(ElemType A[], int l, int r, ElemType pivot, int &lt,
+                   int &gt);
+void QuickSort3Way(ElemType A[], int l, int r); // 0-based, inclusive
+ElemType NthElement(ElemType A[], int n, int k);     // 0-based rank k, clamped to [0, n); returns 0 if n <= 0
+void MultiSelect(ElemType A[], int n, const int ks[], int m); // 0-based ranks, those outside [0, n) are ignored
+void PartialSort(ElemType A[], int n, int k); // 0-based, A[0..k) sorted
+void MergeSortBuffered(ElemType A[], int n, ElemType B[]); // 0-based, B holds n
+void AdaptiveSort(ElemType A[], int n); // 0-based, stable, O(n) on sorted runs
+void ParallelSampleSort(ElemType A[], int n, ElemType B[], // 0-based, stable
+                        int threads = 0);
+
+// Radix sorts (0-based, ElemType is a 32-bit int)
+void RadixSort(ElemType A[], int n, ElemType B[]); // LSD, B holds n
+void RadixSortInPlace(ElemType A[], int n);        // MSD, American flag
+void ParallelRadixSort(ElemType A[], int n, ElemType B[], int threads = 0);
+
+// Indirect sorts (0-based, stable)
+void ArgSort(const ElemType keys[], int n, int idx[]);  // idx[i] = index of i-th key
+void ApplyPermutation(void *data, size_t size, int idx[], int n); // new[i] = old[idx[i]]
+void SortByKey(ElemType keys[], void *payload, int n, size_t payloadSize);
+
+// Streaming top-k (O(k) memory, input fed chunk by chunk)
+typedef struct {  // TopK的状态
+  ElemType *heap; // 目前最好的k个，堆顶为其中最差的（门槛）
+  int k, size;
+  bool largest;   // false保留最小的k个，true保留最大的k个
+} TopKState;
+
+bool TopKInit(TopKState &S, int k, bool largest = false);
+void TopKPush(TopKState &S, const ElemType A[], int n);
+int TopKResult(const TopKState &S, ElemType out[]); // best first, returns count
+void TopKDestroy(TopKState &S);
+int TopK(const ElemType A[], int n, int k, ElemType out[], bool largest = false);
+
+// External sort
+#define EXT_MAX_PASSES 16
+
+typedef struct {                          // 外部排序每趟的I/O统计
+  int passes;                             // 趟数，第0趟为生成初始归并段
+  long long bytesRead[EXT_MAX_PASSES];    // 每趟读入字节数
+  long long bytesWritten[EXT_MAX_PASSES]; // 每趟写出字节数
+} ExternalSortStats;
+
+bool ExternalSort(const char *inputPath, const char *outputPath,
+                  size_t memBudget, ExternalSortStats *stats = NULL,
+                  bool async = false);
+
+// Instrumentation: build with -DSORT_INSTRUMENT for comparison/move counts
+#define SORT_PERF_COUNTERS 4
+
+typedef struct {                    // 一次排序的统计
+  long long comparisons, moves;     // 元素比较/赋值次数，未定义SORT_INSTRUMENT时为-1
+  long long cycles, instructions;   // 以下为硬件计数器，无法打开时为-1
+  long long branchMisses, llcMisses;
+  double ns;                        // 耗时（纳秒）
+  long long startNs;                // 内部使用
+  int perfFd[SORT_PERF_COUNTERS];   // 内部使用
+} SortStats;
+
+void SortStatsBegin(SortStats &st);
+void SortStatsEnd(SortStats &st);
+
+template <class F> SortStats ProfileSort(F run) { // 统计一次run()调用
+  SortStats st;
+  SortStatsBegin(st);
+  run();
+  SortStatsEnd(st);
+  return st;
+}
+
+#endif // SORT_H
@@ -0,0 +1,581 @@
+#ifndef SORT_TEMPLATE_H
+#define SORT_TEMPLATE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Sort.cpp中各排序算法的模板版本（只有头文件）
+ * 每个算法都有两种调用方式：
+ *   Xxx(first, last, comp, proj)   随机访问迭代器
+ *   Xxx(A, n, comp, proj)          指针+长度，下标从0开始
+ * comp为比较器，默认std::less<>；proj为关键字投影，默认取元素本身，
+ * 也可以是成员指针，比如按&Record::id排序。
+ * 比较时调用 comp(proj(a), proj(b))，比较器和投影都是模板参数，编译期内联，没有函数指针开销。
+ */
+
+namespace gsort {
+
+struct Identity { // 默认投影：元素本身就是关键字
+  template <class T> constexpr T &&operator()(T &&x) const noexcept {
+    return std::forward<T>(x);
+  }
+};
+
+namespace detail {
+
+const int INSERT_LEAF = 16; // 区间不超过该长度时改用直接插入排序
+const int MERGE_RUN = 32;   // 归并排序初始段长度
+const int RADIX_MIN = 256;  // Sort()中长度达到该值才走基数排序
+
+template <class Comp, class Proj> struct KeyLess { // 把比较器和投影合成一个“小于”
+  Comp comp;
+  Proj proj;
+  template <class A, class B> bool operator()(A &&a, B &&b) {
+    return comp(std::invoke(proj, std::forward<A>(a)),
+                std::invoke(proj, std::forward<B>(b)));
+  }
+};
+
+template <class Comp, class Proj>
+KeyLess<Comp, Proj> MakeLess(Comp comp, Proj proj) {
+  return KeyLess<Comp, Proj>{comp, proj};
+}
+
+inline int DepthLimit(std::ptrdiff_t n) { // 允许的划分层数 2logn
+  int depth = 0;
+  for (; n > 1; n /= 2)
+    depth++;
+  return 2 * depth;
+}
+
+template <class It, class Less>
+void InsertSortImpl(It first, It last, Less &less) {
+  if (last - first < 2)
+    return;
+  for (It i = first + 1; i != last; ++i) {
+    auto tp = std::move(*i);
+    It j = i;
+    for (; j != first && less(tp, *(j - 1)); --j)
+      *j = std::move(*(j - 1));
+    *j = std::move(tp);
+  }
+}
+
+template <class It, class Less>
+void HeadAdjust(It first, std::ptrdiff_t k, std::ptrdiff_t n,
+                Less &less) { // 下标从0开始的大根堆，调整以k为根的子树
+  auto tp = std::move(first[k]);
+  for (std::ptrdiff_t i = 2 * k + 1; i < n; i = 2 * i + 1) {
+    if (i + 1 < n && less(first[i], first[i + 1]))
+      i++;
+    if (!less(tp, first[i]))
+      break;
+    first[k] = std::move(first[i]);
+    k = i;
+  }
+  first[k] = std::move(tp);
+}
+
+template <class It, class Less>
+void HeapSortImpl(It first, It last, Less &less) {
+  std::ptrdiff_t n = last - first;
+  for (std::ptrdiff_t i = n / 2 - 1; i >= 0; i--)
+    HeadAdjust(first, i, n, less);
+  for (std::ptrdiff_t i = n - 1; i > 0; i--) {
+    std::iter_swap(first, first + i);
+    HeadAdjust(first, 0, i, less);
+  }
+}
+
+template <class It, class Less>
+It Median3(It a, It b, It c, Less &less) { // 返回三者中位数
+  if (less(*a, *b)) {
+    if (less(*b, *c))
+      return b;
+    return less(*a, *c) ? c : a;
+  }
+  if (less(*a, *c))
+    return a;
+  return less(*b, *c) ? c : b;
+}
+
+template <class It, class Less>
+void ChoosePivot(It first, It last, Less &less) { // 三数/九数取中，放到*first
+  std::ptrdiff_t len = last - first;
+  It m = first + len / 2, r = last - 1, mid;
+  if (len > 128) {
+    std::ptrdiff_t s = len / 8;
+    mid = Median3(Median3(first, first + s, first + 2 * s, less),
+                  Median3(m - s, m, m + s, less),
+                  Median3(r - 2 * s, r - s, r, less), less);
+  } else {
+    mid = Median3(first, m, r, less);
+  }
+  std::iter_swap(first, mid);
+}
+
+template <class It, class Less>
+It Partition(It first, It last, Less &less) { // 以*first为枢轴划分，返回枢轴最终位置
+  auto pivot = std::move(*first);
+  It i = first, j = last - 1;
+  while (i < j) {
+    while (i < j && !less(*j, pivot))
+      --j;
+    *i = std::move(*j);
+    while (i < j && !less(pivot, *i))
+      ++i;
+    *j = std::move(*i);
+  }
+  *i = std::move(pivot);
+  return i;
+}
+
+template <class It, class Less>
+void IntroSortLoop(It first, It last, int depth, Less &less) {
+  while (last - first > INSERT_LEAF) {
+    if (depth == 0) {
+      HeapSortImpl(first, last, less);
+      return;
+    }
+    depth--;
+    ChoosePivot(first, last, less);
+    It p = Partition(first, last, less);
+    if (p - first < last - p) { // 只递归较短一侧
+      IntroSortLoop(first, p, depth, less);
+      first = p + 1;
+    } else {
+      IntroSortLoop(p + 1, last, depth, less);
+      last = p;
+    }
+  }
+  InsertSortImpl(first, last, less);
+}
+
+template <class It, class Less>
+void FlagPartition(It first, It last, It &lt, It &gt,
+                   Less &less) { // 三路划分，以*first为枢轴；结束后[lt,gt)等于枢轴
+  /**
+   * 枢轴留在*first不动，只划分(first,last)，比较时直接引用*first，不复制枢轴，
+   * 只能移动的类型也能用。最后把枢轴与小于段的最后一个交换，并入等于段。
+   */
+  It i = first + 1, j = first + 1, k = last;
+  while (j < k) {
+    if (less(*j, *first)) {
+      std::iter_swap(i, j);
+      ++i, ++j;
+    } else if (less(*first, *j)) {
+      --k;
+      std::iter_swap(j, k);
+    } else {
+      ++j;
+    }
+  }
+  --i;
+  std::iter_swap(first, i);
+  lt = i;
+  gt = k;
+}
+
+template <class It, class Less>
+void QuickSort3WayLoop(It first, It last, int depth, Less &less) {
+  while (last - first > INSERT_LEAF) {
+    if (depth == 0) {
+      HeapSortImpl(first, last, less);
+      return;
+    }
+    depth--;
+    ChoosePivot(first, last, less);
+    It lt, gt;
+    FlagPartition(first, last, lt, gt, less);
+    if (lt - first < last - gt) {
+      QuickSort3WayLoop(first, lt, depth, less);
+      first = gt;
+    } else {
+      QuickSort3WayLoop(gt, last, depth, less);
+      last = lt;
+    }
+  }
+  InsertSortImpl(first, last, less);
+}
+
+template <class It, class Less>
+void MergeSortImpl(It first, It last, Less &less) {
+  typedef typename std::iterator_traits<It>::value_type T;
+  std::ptrdiff_t n = last - first;
+  if (n < 2)
+    return;
+  for (std::ptrdiff_t l = 0; l < n; l += MERGE_RUN)
+    InsertSortImpl(first + l, first + (l + MERGE_RUN < n ? l + MERGE_RUN : n),
+                   less);
+  if (n <= MERGE_RUN)
+    return;
+
+  std::vector<T> buf(std::make_move_iterator(first),
+                     std::make_move_iterator(last));
+  bool inBuf = true; // 当前有序段在buf中还是在原序列中
+  for (std::ptrdiff_t w = MERGE_RUN; w < n; w *= 2) {
+    for (std::ptrdiff_t l = 0; l < n; l += 2 * w) {
+      std::ptrdiff_t m = l + w < n ? l + w : n;
+      std::ptrdiff_t r = l + 2 * w < n ? l + 2 * w : n;
+      if (inBuf)
+        std::merge(std::make_move_iterator(buf.begin() + l),
+                   std::make_move_iterator(buf.begin() + m),
+                   std::make_move_iterator(buf.begin() + m),
+                   std::make_move_iterator(buf.begin() + r), first + l,
+                   [&less](const T &a, const T &b) { return less(a, b); });
+      else
+        std::merge(std::make_move_iterator(first + l),
+                   std::make_move_iterator(first + m),
+                   std::make_move_iterator(first + m),
+                   std::make_move_iterator(first + r), buf.begin() + l,
+                   [&less](const T &a, const T &b) { return less(a, b); });
+    }
+    inBuf = !inBuf;
+  }
+  if (inBuf)
+    std::move(buf.begin(), buf.end(), first);
+}
+
+template <class Key> struct RadixKey { // 把算术类型关键字映射成按无符号比较即有序的整数
+  typedef typename std::conditional<
+      sizeof(Key) <= 4,
+      typename std::conditional<sizeof(Key) <= 2,
+                                typename std::conditional<sizeof(Key) == 1,
+                                                          std::uint8_t,
+                                                          std::uint16_t>::type,
+                                std::uint32_t>::type,
+      std::uint64_t>::type Bits;
+
+  static Bits Get(Key k) {
+    Bits b;
+    std::memcpy(&b, &k, sizeof(Key));
+    const Bits top = Bits(1) << (sizeof(Key) * 8 - 1);
+    if constexpr (std::is_floating_point<Key>::value)
+      return (b & top) ? Bits(~b) : Bits(b | top); // 负数全部取反，正数翻转符号位
+    else if constexpr (std::is_signed<Key>::value)
+      return Bits(b ^ top); // 翻转符号位
+    else
+      return b;
+  }
+};
+
+template <class It, class Proj>
+void RadixSortImpl(It first, It last, Proj &proj, bool descending) { // 稳定的LSD基数排序
+  typedef typename std::iterator_traits<It>::value_type T;
+  typedef typename std::decay<decltype(std::invoke(proj, *first))>::type Key;
+  typedef typename RadixKey<Key>::Bits Bits;
+  const int PASSES = sizeof(Key);
+  std::ptrdiff_t n = last - first;
+  if (n < 2)
+    return;
+
+  std::vector<std::ptrdiff_t> count(PASSES * 256, 0);
+  for (It i = first; i != last; ++i) { // 一次扫描统计所有趟的直方图
+    Bits k = RadixKey<Key>::Get(std::invoke(proj, *i));
+    if (descending)
+      k = Bits(~k);
+    for (int p = 0; p < PASSES; p++)
+      count[p * 256 + ((k >> (8 * p)) & 0xff)]++;
+  }
+
+  std::vector<T> buf(first, last), other(buf);
+  for (int p = 0; p < PASSES; p++) {
+    std::ptrdiff_t *c = &count[p * 256];
+    Bits k0 = RadixKey<Key>::Get(std::invoke(proj, buf[0]));
+    if (descending)
+      k0 = Bits(~k0);
+    if (c[(k0 >> (8 * p)) & 0xff] == n) // 这一位全部相同
+      continue;
+    std::ptrdiff_t pos[256], sum = 0;
+    for (int d = 0; d < 256; d++) {
+      pos[d] = sum;
+      sum += c[d];
+    }
+    for (std::ptrdiff_t i = 0; i < n; i++) {
+      Bits k = RadixKey<Key>::Get(std::invoke(proj, buf[i]));
+      if (descending)
+        k = Bits(~k);
+      other[pos[(k >> (8 * p)) & 0xff]++] = std::move(buf[i]);
+    }
+    buf.swap(other);
+  }
+  std::move(buf.begin(), buf.end(), first);
+}
+
+template <class It, class Less>
+void Select(It first, It nth, It last, Less &less) { // 三路划分的快速选择，层数用尽时对剩余部分堆排序
+  int depth = DepthLimit(last - first);
+  while (last - first > INSERT_LEAF) {
+    if (depth-- == 0) {
+      HeapSortImpl(first, last, less);
+      return;
+    }
+    ChoosePivot(first, last, less);
+    It lt, gt;
+    FlagPartition(first, last, lt, gt, less);
+    if (nth < lt)
+      last = lt;
+    else if (nth >= gt)
+      first = gt;
+    else
+      return;
+  }
+  InsertSortImpl(first, last, less);
+}
+
+} // namespace detail
+
+// 以下为对外接口
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void InsertSort(It first, It last, Comp comp = {}, Proj proj = {}) { // 直接插入排序，稳定
+  auto less = detail::MakeLess(comp, proj);
+  detail::InsertSortImpl(first, last, less);
+}
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void HalfInsertSort(It first, It last, Comp comp = {}, Proj proj = {}) { // 折半插入排序，稳定
+  auto less = detail::MakeLess(comp, proj);
+  for (It i = first + (first != last); i < last; ++i) {
+    auto tp = std::move(*i);
+    It l = first, r = i; // 在[first,i)中找第一个大于tp的位置
+    while (l < r) {
+      It mid = l + (r - l) / 2;
+      if (less(tp, *mid))
+        r = mid;
+      else
+        l = mid + 1;
+    }
+    std::move_backward(l, i, i + 1);
+    *l = std::move(tp);
+  }
+}
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void ShellSort(It first, It last, Comp comp = {}, Proj proj = {}) { // 希尔排序
+  auto less = detail::MakeLess(comp, proj);
+  std::ptrdiff_t n = last - first;
+  for (std::ptrdiff_t dk = n / 2; dk >= 1; dk /= 2) {
+    for (std::ptrdiff_t i = dk; i < n; i++) {
+      auto tp = std::move(first[i]);
+      std::ptrdiff_t j = i - dk;
+      for (; j >= 0 && less(tp, first[j]); j -= dk)
+        first[j + dk] = std::move(first[j]);
+      first[j + dk] = std::move(tp);
+    }
+  }
+}
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void BubbleSort(It first, It last, Comp comp = {}, Proj proj = {}) { // 冒泡排序，稳定
+  auto less = detail::MakeLess(comp, proj);
+  for (It end = last; end - first > 1; --end) {
+    bool flag = false;
+    for (It j = first + 1; j != end; ++j) {
+      if (less(*j, *(j - 1))) {
+        std::iter_swap(j, j - 1);
+        flag = true;
+      }
+    }
+    if (!flag)
+      return;
+  }
+}
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void Bubble2Sort(It first, It last, Comp comp = {}, Proj proj = {}) { // 双向冒泡排序，稳定
+  auto less = detail::MakeLess(comp, proj);
+  if (last - first < 2)
+    return;
+  It l = first, r = last - 1;
+  bool flag = true;
+  while (l < r && flag) {
+    flag = false;
+    for (It i = l; i < r; ++i) {
+      if (less(*(i + 1), *i)) {
+        std::iter_swap(i, i + 1);
+        flag = true;
+      }
+    }
+    --r;
+    for (It i = r; i > l; --i) {
+      if (less(*i, *(i - 1))) {
+        std::iter_swap(i, i - 1);
+        flag = true;
+      }
+    }
+    ++l;
+  }
+}
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void SelectSort(It first, It last, Comp comp = {}, Proj proj = {}) { // 选择排序
+  auto less = detail::MakeLess(comp, proj);
+  for (It i = first; i != last; ++i) {
+    It min = i;
+    for (It j = i + 1; j != last; ++j)
+      if (less(*j, *min))
+        min = j;
+    if (min != i)
+      std::iter_swap(i, min);
+  }
+}
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void HeapSort(It first, It last, Comp comp = {}, Proj proj = {}) { // 堆排序
+  auto less = detail::MakeLess(comp, proj);
+  detail::HeapSortImpl(first, last, less);
+}
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void QuickSort(It first, It last, Comp comp = {}, Proj proj = {}) { // 快速排序，三数取中，只递归较短一侧
+  auto less = detail::MakeLess(comp, proj);
+  while (last - first > 1) {
+    std::iter_swap(first, detail::Median3(first, first + (last - first) / 2,
+                                          last - 1, less));
+    It p = detail::Partition(first, last, less);
+    if (p - first < last - p) {
+      QuickSort(first, p, comp, proj);
+      first = p + 1;
+    } else {
+      QuickSort(p + 1, last, comp, proj);
+      last = p;
+    }
+  }
+}
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void IntroSort(It first, It last, Comp comp = {}, Proj proj = {}) { // 内省排序
+  auto less = detail::MakeLess(comp, proj);
+  detail::IntroSortLoop(first, last, detail::DepthLimit(last - first), less);
+}
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void QuickSort3Way(It first, It last, Comp comp = {}, Proj proj = {}) { // 三路快排
+  auto less = detail::MakeLess(comp, proj);
+  detail::QuickSort3WayLoop(first, last, detail::DepthLimit(last - first), less);
+}
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void MergeSort(It first, It last, Comp comp = {}, Proj proj = {}) { // 自底向上归并排序，稳定
+  auto less = detail::MakeLess(comp, proj);
+  detail::MergeSortImpl(first, last, less);
+}
+
+template <class It, class Proj = Identity>
+void RadixSort(It first, It last, Proj proj = {}) { // 基数排序，关键字须为算术类型，升序，稳定
+  detail::RadixSortImpl(first, last, proj, false);
+}
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void NthElement(It first, It nth, It last, Comp comp = {}, Proj proj = {}) { // 把第nth位放好
+  auto less = detail::MakeLess(comp, proj);
+  detail::Select(first, nth, last, less);
+}
+
+template <class It, class Comp = std::less<>, class Proj = Identity>
+void Sort(It first, It last, Comp comp = {}, Proj proj = {}) { // 通用入口
+  /**
+   * 关键字为算术类型（bool、long double除外）、元素可平凡复制、比较器为std::less/std::greater时，
+   * 编译期选择基数排序（长度不小于RADIX_MIN时），否则用内省排序。
+   */
+  typedef typename std::iterator_traits<It>::value_type T;
+  typedef typename std::decay<decltype(std::invoke(proj, *first))>::type Key;
+  if constexpr (std::is_arithmetic<Key>::value && !std::is_same<Key, bool>::value &&
+                sizeof(Key) <= 8 && std::is_trivially_copyable<T>::value) {
+    constexpr bool asc = std::is_same<Comp, std::less<>>::value ||
+                         std::is_same<Comp, std::less<Key>>::value;
+    constexpr bool desc = std::is_same<Comp, std::greater<>>::value ||
+                          std::is_same<Comp, std::greater<Key>>::value;
+    if constexpr (asc || desc) {
+      if (last - first >= detail::RADIX_MIN) {
+        detail::RadixSortImpl(first, last, proj, desc);
+        return;
+      }
+    }
+  }
+  IntroSort(first, last, comp, proj);
+}
+
+// 指针+长度形式，下标从0开始
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void InsertSort(T *A, int n, Comp comp = {}, Proj proj = {}) {
+  InsertSort(A, A + n, comp, proj);
+}
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void HalfInsertSort(T *A, int n, Comp comp = {}, Proj proj = {}) {
+  HalfInsertSort(A, A + n, comp, proj);
+}
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void ShellSort(T *A, int n, Comp comp = {}, Proj proj = {}) {
+  ShellSort(A, A + n, comp, proj);
+}
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void BubbleSort(T *A, int n, Comp comp = {}, Proj proj = {}) {
+  BubbleSort(A, A + n, comp, proj);
+}
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void Bubble2Sort(T *A, int n, Comp comp = {}, Proj proj = {}) {
+  Bubble2Sort(A, A + n, comp, proj);
+}
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void SelectSort(T *A, int n, Comp comp = {}, Proj proj = {}) {
+  SelectSort(A, A + n, comp, proj);
+}
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void HeapSort(T *A, int n, Comp comp = {}, Proj proj = {}) {
+  HeapSort(A, A + n, comp, proj);
+}
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void QuickSort(T *A, int n, Comp comp = {}, Proj proj = {}) {
+  QuickSort(A, A + n, comp, proj);
+}
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void IntroSort(T *A, int n, Comp comp = {}, Proj proj = {}) {
+  IntroSort(A, A + n, comp, proj);
+}
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void QuickSort3Way(T *A, int n, Comp comp = {}, Proj proj = {}) {
+  QuickSort3Way(A, A + n, comp, proj);
+}
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void MergeSort(T *A, int n, Comp comp = {}, Proj proj = {}) {
+  MergeSort(A, A + n, comp, proj);
+}
+
+template <class T, class Proj = Identity>
+void RadixSort(T *A, int n, Proj proj = {}) {
+  RadixSort(A, A + n, proj);
+}
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void NthElement(T *A, int n, int k, Comp comp = {}, Proj proj = {}) {
+  NthElement(A, A + k, A + n, comp, proj);
+}
+
+template <class T, class Comp = std::less<>, class Proj = Identity>
+void Sort(T *A, int n, Comp comp = {}, Proj proj = {}) {
+  Sort(A, A + n, comp, proj);
+}
+
+} // namespace gsort
+
+#endif // SORT_TEMPLATE_H
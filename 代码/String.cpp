@@ -1,18 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-
-#define MAXLEN 255 // 最大长度
-
-typedef struct {
-    char ch[MAXLEN];    // 每个分量存储一个字符
-    int length;         // 记录实际长度
-}SString;               // 定长顺序存储
-
-typedef struct {
-    char *ch;           // 指向串的基地址
-    int length;
-}HString;               // 堆分配存储
+#include "String.h"
 
 void StrAssign(SString &T, const char* chars) {
     T.length = 0;
@@ -0,0 +1,29 @@
+#ifndef STRING_H
+#define STRING_H
+
+#define MAXLEN 255 // 最大长度
+
+typedef struct {
+    char ch[MAXLEN];    // 每个分量存储一个字符
+    int length;         // 记录实际长度
+}SString;               // 定长顺序存储
+
+typedef struct {
+    char *ch;           // 指向串的基地址
+    int length;
+}HString;               // 堆分配存储
+
+// Function declarations
+
+// String sorting (StringSort.cpp)
+// 两种存储都与StrAssign一致：字符存放在ch[1..length]，ch[0]不用，串中不含'\0'
+typedef enum {
+    STR_SORT_MKQS,  // 多关键字快排（Bentley-Sedgewick）
+    STR_SORT_RADIX  // MSD基数排序，小桶用LCP归并排序
+} StrSortMethod;
+
+void StrSort(SString *A[], int n, StrSortMethod method = STR_SORT_MKQS); // 排序指针数组，不搬动SString本身
+void StrSort(HString A[], int n, StrSortMethod method = STR_SORT_MKQS);
+int StrCompare(const HString &S, const HString &T); // 字典序比较，S<T时返回负数
+
+#endif // STRING_H
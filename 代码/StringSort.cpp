@@ -0,0 +1,251 @@
+#include "String.h"
+#include <string.h>
+#include <vector>
+
+/**
+ * 字符串排序
+ * 逐个比较的排序每次比较都要从头扫过公共前缀，URL这类前缀很长的串大部分时间花在这上面。
+ * 这里的两种方法都是按位置逐个字符处理，已经确定相同的前缀不再比较：
+ * 1. 多关键字快排：按第d个字符三路划分，等于枢轴的一段去比较第d+1个字符
+ * 2. MSD基数排序：按第d个字符分到256个桶，各桶再按第d+1个字符分；
+ *    桶小了以后改用LCP归并排序，归并时利用相邻串的最长公共前缀跳过已知相同的部分
+ * 排序的对象是StrItem：串的起始地址、长度，以及从当前位置起的4个字符（cache）。
+ * 三路划分和分桶只看cache，不必每次都顺着指针去读串，每处理4个字符才回读一次。
+ */
+
+typedef struct {
+  const unsigned char *s; // 第一个字符的地址（即ch+1）
+  int len;
+  unsigned int cache; // 从第depth个字符起的4个字符，高位在前，串结束后补0
+  int id;             // 在原数组中的下标
+} StrItem;
+
+static const int STR_SMALL = 16;       // 不超过该长度的区间用插入排序
+static const int STR_RADIX_MIN = 64;   // MSD基数排序的桶小于该长度时改用LCP归并排序
+
+static inline unsigned int CharAt(const StrItem &x, int d) { // 第d个字符（从0开始），串结束后为0
+  return d < x.len ? x.s[d] : 0;
+}
+
+static inline unsigned int Load4(const StrItem &x, int d) { // 取第d..d+3个字符，高位在前，比较整数即比较字典序
+  if (d + 4 <= x.len)
+    return (unsigned int)x.s[d] << 24 | (unsigned int)x.s[d + 1] << 16 |
+           (unsigned int)x.s[d + 2] << 8 | x.s[d + 3];
+  return CharAt(x, d) << 24 | CharAt(x, d + 1) << 16 | CharAt(x, d + 2) << 8 |
+         CharAt(x, d + 3);
+}
+
+static inline void SwapItem(StrItem &a, StrItem &b) {
+  StrItem tp = a;
+  a = b;
+  b = tp;
+}
+
+static int CompareFrom(const StrItem &a, const StrItem &b, int d) { // 已知前d个字符相同，比较剩下的部分
+  int n = a.len < b.len ? a.len : b.len;
+  if (d < n) {
+    int c = memcmp(a.s + d, b.s + d, n - d);
+    if (c != 0)
+      return c;
+  }
+  return a.len - b.len;
+}
+
+static void InsertSortFrom(StrItem a[], int n, int d) { // 前d个字符相同的小区间直接插入排序
+  for (int i = 1; i < n; i++) {
+    StrItem tp = a[i];
+    int j = i - 1;
+    while (j >= 0 && (a[j].cache > tp.cache ||
+                      (a[j].cache == tp.cache && CompareFrom(a[j], tp, d) > 0))) {
+      a[j + 1] = a[j];
+      j--;
+    }
+    a[j + 1] = tp;
+  }
+}
+
+static void MultikeyQuickSort(StrItem a[], int n, int d) { // a[0..n)前d个字符相同，cache为第d..d+3个字符
+  /**
+   * Bentley-Sedgewick多关键字快排，一次比较4个字符：
+   * 1. 取三个cache的中位数作枢轴，按cache三路划分
+   * 2. 小于和大于两段仍从第d个字符比起，递归处理
+   * 3. 等于的一段这4个字符都相同：若枢轴的最后一个字节为0，说明串已经结束，这些串完全相同；
+   *    否则d+=4，更新cache后继续循环处理
+   */
+  while (n > STR_SMALL) {
+    unsigned int x = a[0].cache, y = a[n / 2].cache, z = a[n - 1].cache;
+    unsigned int pivot = x < y ? (y < z ? y : (x < z ? z : x))
+                               : (x < z ? x : (y < z ? z : y));
+    int lt = 0, i = 0, gt = n - 1;
+    while (i <= gt) {
+      if (a[i].cache < pivot)
+        SwapItem(a[lt++], a[i++]);
+      else if (a[i].cache > pivot)
+        SwapItem(a[i], a[gt--]);
+      else
+        i++;
+    }
+    MultikeyQuickSort(a, lt, d);
+    MultikeyQuickSort(a + gt + 1, n - gt - 1, d);
+    if ((pivot & 0xff) == 0) // 等于的一段已经全部相同
+      return;
+    a += lt;
+    n = gt - lt + 1;
+    d += 4;
+    for (int k = 0; k < n; k++)
+      a[k].cache = Load4(a[k], d);
+  }
+  InsertSortFrom(a, n, d);
+}
+
+static void LcpMerge(const StrItem a[], const int L[], int m, int n,
+                     StrItem out[], int outL[], int d) { // 归并a[0..m)和a[m..n)，L[k]为a[k-1]与a[k]的LCP
+  /**
+   * hl、hr分别为左右两段当前首元素与上一个输出元素的LCP。
+   * 上一个输出不大于两个首元素，所以LCP较大的一个更小，直接输出，不用比较字符；
+   * 只有hl==hr时才从第hl个字符开始比较，比较得到的LCP又成为另一侧新的hr或hl。
+   * 每个字符最多被比较一次“相同”，总的字符比较次数为O(nlogn + 所有LCP之和)。
+   */
+  int i = 0, j = m, k = 0, hl = d, hr = d;
+  while (i < m && j < n) {
+    if (hl > hr) {
+      out[k] = a[i], outL[k++] = hl;
+      hl = ++i < m ? L[i] : 0;
+    } else if (hl < hr) {
+      out[k] = a[j], outL[k++] = hr;
+      hr = ++j < n ? L[j] : 0;
+    } else {
+      int h = hl;
+      while (CharAt(a[i], h) == CharAt(a[j], h) && CharAt(a[i], h) != 0)
+        h++;
+      if (CharAt(a[i], h) <= CharAt(a[j], h)) { // 相等时取左边，保持稳定
+        out[k] = a[i], outL[k++] = hl;
+        hr = h;
+        hl = ++i < m ? L[i] : 0;
+      } else {
+        out[k] = a[j], outL[k++] = hr;
+        hl = h;
+        hr = ++j < n ? L[j] : 0;
+      }
+    }
+  }
+  for (int first = 1; i < m; i++, first = 0)
+    out[k] = a[i], outL[k++] = first ? hl : L[i];
+  for (int first = 1; j < n; j++, first = 0)
+    out[k] = a[j], outL[k++] = first ? hr : L[j];
+}
+
+static void LcpMergeSort(StrItem a[], int L[], StrItem tmp[], int tmpL[],
+                         int n, int d) { // 前d个字符相同，排序后L[k]为a[k-1]与a[k]的LCP
+  if (n < 2) {
+    if (n == 1)
+      L[0] = d;
+    return;
+  }
+  int m = n / 2;
+  LcpMergeSort(a, L, tmp, tmpL, m, d);
+  LcpMergeSort(a + m, L + m, tmp + m, tmpL + m, n - m, d);
+  LcpMerge(a, L, m, n, tmp, tmpL, d);
+  memcpy(a, tmp, n * sizeof(StrItem));
+  memcpy(L, tmpL, n * sizeof(int));
+}
+
+typedef struct {
+  StrItem *tmp;
+  int *L, *tmpL;
+} RadixBuffers; // MSD基数排序的辅助空间，与待排数组等长
+
+static void StrRadixSort(StrItem a[], int n, int d, int offset,
+                         RadixBuffers &buf) { // a对应原数组的a[offset..offset+n)，前d个字符相同
+  /**
+   * 每层按一个字符分256个桶（计数、分配到tmp、再复制回来）。
+   * 字符从cache中取，cache放的是从4的倍数位置开始的4个字符，每进入新的4个字符才回读串。
+   * 0号桶的串已经结束，彼此相同，不必再分。
+   * 公共前缀上每层都只有一个非空桶，分配是白做的：回读cache时若4个字符全都相同就整段跳过，
+   * 只有一个非空桶时也不做分配，直接进入下一个字符。
+   */
+  if (n < STR_RADIX_MIN) {
+    LcpMergeSort(a, buf.L + offset, buf.tmp + offset, buf.tmpL + offset, n, d);
+    return;
+  }
+  int count[256], pos[256], shift;
+  for (;;) {
+    if (d % 4 == 0 && d > 0) {
+      bool same = true;
+      for (int i = 0; i < n; i++) {
+        a[i].cache = Load4(a[i], d);
+        same &= a[i].cache == a[0].cache;
+      }
+      if (same && (a[0].cache & 0xff) != 0) { // 这4个字符都相同且串都未结束
+        d += 4;
+        continue;
+      }
+    }
+    shift = 24 - 8 * (d % 4);
+    memset(count, 0, sizeof(count));
+    for (int i = 0; i < n; i++)
+      count[(a[i].cache >> shift) & 0xff]++;
+    int c0 = (a[0].cache >> shift) & 0xff;
+    if (count[c0] < n)
+      break;
+    if (c0 == 0) // 全部在0号桶，都已结束
+      return;
+    d++;
+  }
+  for (int c = 0, sum = 0; c < 256; c++) {
+    pos[c] = sum;
+    sum += count[c];
+  }
+  StrItem *tmp = buf.tmp + offset;
+  for (int i = 0; i < n; i++)
+    tmp[pos[(a[i].cache >> shift) & 0xff]++] = a[i];
+  memcpy(a, tmp, n * sizeof(StrItem));
+  for (int c = 1, start = count[0]; c < 256; c++) {
+    if (count[c] > 1)
+      StrRadixSort(a + start, count[c], d + 1, offset + start, buf);
+    start += count[c];
+  }
+}
+
+static void SortItems(StrItem a[], int n, StrSortMethod method) {
+  for (int i = 0; i < n; i++)
+    a[i].cache = Load4(a[i], 0);
+  if (method == STR_SORT_RADIX) {
+    std::vector<StrItem> tmp(n);
+    std::vector<int> L(n), tmpL(n);
+    RadixBuffers buf = {tmp.data(), L.data(), tmpL.data()};
+    StrRadixSort(a, n, 0, 0, buf);
+  } else {
+    MultikeyQuickSort(a, n, 0);
+  }
+}
+
+void StrSort(SString *A[], int n, StrSortMethod method) { // 字符串排序，只重排指针
+  std::vector<StrItem> a(n);
+  for (int i = 0; i < n; i++)
+    a[i] = {(const unsigned char *)A[i]->ch + 1, A[i]->length, 0, i};
+  SortItems(a.data(), n, method);
+  std::vector<SString *> sorted(n);
+  for (int i = 0; i < n; i++)
+    sorted[i] = A[a[i].id];
+  for (int i = 0; i < n; i++)
+    A[i] = sorted[i];
+}
+
+void StrSort(HString A[], int n, StrSortMethod method) { // 字符串排序，HString只有指针和长度，直接重排
+  std::vector<StrItem> a(n);
+  for (int i = 0; i < n; i++)
+    a[i] = {(const unsigned char *)A[i].ch + 1, A[i].length, 0, i};
+  SortItems(a.data(), n, method);
+  std::vector<HString> sorted(n);
+  for (int i = 0; i < n; i++)
+    sorted[i] = A[a[i].id];
+  for (int i = 0; i < n; i++)
+    A[i] = sorted[i];
+}
+
+int StrCompare(const HString &S, const HString &T) { // 字典序比较
+  StrItem a = {(const unsigned char *)S.ch + 1, S.length, 0, 0};
+  StrItem b = {(const unsigned char *)T.ch + 1, T.length, 0, 0};
+  return CompareFrom(a, b, 0);
+}
@@ -0,0 +1,186 @@
+#include "Search.h"
+#include <chrono>
+#include <climits>
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * 查找性能测试
+ * 有序表为 0,2,4,...,2(n-1)，查询键在[0,2n)中均匀随机，约一半命中。
+ * 每种查找结构先由有序表构建，再连续做QUERIES次互不依赖的查询，给出每次查询的平均耗时；
+ * 构建时间不计入。结果与BinarySearch逐个核对，ok列为0说明有不一致。
+ * 默认测到n=10^8；n=10^9时有序表本身占4GB，各结构另需同等或更多内存，合计十几GB，需用--max-n指定。
+ * 某个规模内存不足时跳过该规模及更大的规模。
+ *
+ * 用法：search_bench [--min-n=N] [--max-n=N] [--format=csv|json] [--search=名字]
+ */
+
+typedef struct {
+  const char *name;
+  void *(*build)(SSTable ST); // 由有序表构建查找结构，失败返回NULL
+  int (*find)(void *index, SSTable ST, ElemType key); // 返回值与BinarySearch相同
+  void (*destroy)(void *index);
+} SearchEntry;
+
+static SearchEntry SEARCHES[] = {
+    {"BinarySearch", [](SSTable ST) -> void * { return ST.elem; },
+     [](void *, SSTable ST, ElemType key) { return BinarySearch(ST, key); },
+     [](void *) {}},
+    {"Eytzinger",
+     [](SSTable ST) -> void * {
+       EytzingerTable *E = new EytzingerTable;
+       if (!EytzingerBuild(ST, *E)) {
+         delete E;
+         return NULL;
+       }
+       return E;
+     },
+     [](void *E, SSTable, ElemType key) { return EytzingerSearch(*(EytzingerTable *)E, key); },
+     [](void *E) {
+       EytzingerDestroy(*(EytzingerTable *)E);
+       delete (EytzingerTable *)E;
+     }},
+    {"STree",
+     [](SSTable ST) -> void * {
+       STree *T = new STree;
+       if (!STreeBuild(ST, *T)) {
+         delete T;
+         return NULL;
+       }
+       return T;
+     },
+     [](void *T, SSTable, ElemType key) { return STreeSearch(*(STree *)T, key); },
+     [](void *T) {
+       STreeDestroy(*(STree *)T);
+       delete (STree *)T;
+     }},
+    {"HashTable",
+     [](SSTable ST) -> void * {
+       HashTable *H = new HashTable;
+       if (!HashInit(*H, ST.TableLen)) {
+         delete H;
+         return NULL;
+       }
+       for (int i = 0; i < ST.TableLen; i++)
+         HashInsert(*H, ST.elem[i], i);
+       return H;
+     },
+     [](void *H, SSTable, ElemType key) {
+       ElemType i;
+       return HashFind(*(HashTable *)H, key, &i) ? (int)i : -1;
+     },
+     [](void *H) {
+       HashDestroy(*(HashTable *)H);
+       delete (HashTable *)H;
+     }},
+};
+
+static const int NSEARCHES = sizeof(SEARCHES) / sizeof(SearchEntry);
+static const int QUERIES = 1 << 22;
+
+static unsigned long long rng = 88172645463325252ULL;
+static unsigned int NextRand() { // xorshift64
+  rng ^= rng << 13;
+  rng ^= rng >> 7;
+  rng ^= rng << 17;
+  return (unsigned int)(rng >> 16);
+}
+
+int main(int argc, char **argv) {
+  long long minN = 1000, maxN = 100000000;
+  bool json = false;
+  std::string onlySearch;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.compare(0, 8, "--max-n=") == 0)
+      maxN = atoll(arg.c_str() + 8);
+    else if (arg.compare(0, 8, "--min-n=") == 0)
+      minN = atoll(arg.c_str() + 8);
+    else if (arg == "--format=json")
+      json = true;
+    else if (arg == "--format=csv")
+      json = false;
+    else if (arg.compare(0, 9, "--search=") == 0)
+      onlySearch = arg.substr(9);
+    else {
+      fprintf(stderr,
+              "usage: %s [--min-n=N] [--max-n=N] [--format=csv|json] "
+              "[--search=NAME]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (minN < 1 || maxN > INT_MAX) { // n从minN起每次乘10，为0时不会前进；SSTable长度为int
+    fprintf(stderr, "%s: need 1 <= min-n and max-n <= %d\n", argv[0], INT_MAX);
+    return 1;
+  }
+
+  if (json)
+    printf("[\n");
+  else
+    printf("search,n,ns_per_query,build_ms,ok\n");
+  bool first = true;
+  for (long long n = minN; n <= maxN; n *= 10) {
+    std::vector<ElemType> elem, keys;
+    std::vector<int> expect;
+    try {
+      elem.resize(n);
+      keys.resize(QUERIES);
+      expect.resize(QUERIES);
+    } catch (const std::bad_alloc &) {
+      fprintf(stderr, "n=%lld: out of memory, skipping this and larger sizes\n", n);
+      break;
+    }
+    for (long long i = 0; i < n; i++)
+      elem[i] = (ElemType)(2 * i);
+    SSTable ST = {elem.data(), (int)n};
+    for (int q = 0; q < QUERIES; q++) {
+      keys[q] = (ElemType)(((unsigned long long)NextRand() << 16 ^ NextRand()) % (2 * n));
+      expect[q] = BinarySearch(ST, keys[q]);
+    }
+
+    for (int si = 0; si < NSEARCHES; si++) {
+      const SearchEntry &s = SEARCHES[si];
+      if (!onlySearch.empty() && onlySearch != s.name)
+        continue;
+      std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+      void *index = NULL;
+      try {
+        index = s.build(ST);
+      } catch (const std::bad_alloc &) {
+      }
+      std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+      if (index == NULL) {
+        fprintf(stderr, "%s/%lld: build failed\n", s.name, n);
+        continue;
+      }
+      int ok = 1;
+      for (int q = 0; q < QUERIES; q++) // 先核对一遍，顺便预热
+        if (s.find(index, ST, keys[q]) != expect[q])
+          ok = 0;
+      long long sum = 0;
+      std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+      for (int q = 0; q < QUERIES; q++)
+        sum += s.find(index, ST, keys[q]);
+      std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+      s.destroy(index);
+      if (sum == -1) // 防止查询被优化掉
+        fprintf(stderr, "\n");
+
+      double nsPerQuery = std::chrono::duration<double, std::nano>(t3 - t2).count() / QUERIES;
+      double buildMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+      if (json)
+        printf("%s  {\"search\": \"%s\", \"n\": %lld, \"ns_per_query\": %.3f, "
+               "\"build_ms\": %.3f, \"ok\": %s}",
+               first ? "" : ",\n", s.name, n, nsPerQuery, buildMs, ok ? "true" : "false");
+      else
+        printf("%s,%lld,%.3f,%.3f,%d\n", s.name, n, nsPerQuery, buildMs, ok);
+      first = false;
+      fflush(stdout);
+    }
+  }
+  if (json)
+    printf("\n]\n");
+  return 0;
+}
@@ -0,0 +1,276 @@
+#include "Sort.h"
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * 排序性能测试
+ * 对每个排序 x 每种输入分布 x 每个规模，在fork出的子进程中生成数据并排序，
+ * 这样峰值内存(ru_maxrss)只反映这一组测试。
+ * 每组的第一次排序用SortStats统计硬件计数器；以SORT_INSTRUMENT编译
+ * （sort_bench_instrumented）时还会给出比较和赋值次数，但插桩本身会拖慢计时。
+ *
+ * 用法：sort_bench [--max-n=N] [--min-n=N] [--format=csv|json]
+ *                  [--sort=名字] [--dist=名字] [--threads=N]
+ */
+
+typedef void (*SortFunc)(ElemType A[], int n, ElemType B[], int threads);
+
+typedef struct {
+  const char *name;
+  SortFunc run; // A[0]留作哨兵，数据在A[1..n]；B为n个元素的辅助数组
+  int maxN;     // 超过该规模不测（平方级排序太慢）
+} SortEntry;
+
+static const int QUADRATIC_MAX = 10000;
+
+static SortEntry SORTS[] = {
+    {"InsertSort", [](ElemType A[], int n, ElemType *, int) { InsertSort(A, n); }, QUADRATIC_MAX},
+    {"HalfInsertSort", [](ElemType A[], int n, ElemType *, int) { HalfInsertSort(A, n); }, QUADRATIC_MAX},
+    {"ShellSort", [](ElemType A[], int n, ElemType *, int) { ShellSort(A + 1, n); }, 10000000},
+    {"BubbleSort", [](ElemType A[], int n, ElemType *, int) { BubbleSort(A + 1, n); }, QUADRATIC_MAX},
+    {"QuickSort", [](ElemType A[], int n, ElemType *, int) { QuickSort(A, 1, n); }, QUADRATIC_MAX},
+    {"SelectSort", [](ElemType A[], int n, ElemType *, int) { SelectSort(A + 1, n); }, QUADRATIC_MAX},
+    {"MergeSort", [](ElemType A[], int n, ElemType *, int) { MergeSort(A, 1, n); }, 1 << 30},
+    {"HeapSort", [](ElemType A[], int n, ElemType *, int) { HeapSort(A, n); }, 1 << 30},
+    {"BinaryHeapSort", [](ElemType A[], int n, ElemType *, int) { BinaryHeapSort(A, n); }, 1 << 30},
+    {"Bubble2Sort", [](ElemType A[], int n, ElemType *, int) { Bubble2Sort(A + 1, n); }, QUADRATIC_MAX},
+    {"QuickSort2", [](ElemType A[], int n, ElemType *, int) { QuickSort2(A, 1, n); }, QUADRATIC_MAX},
+    {"IntroSort", [](ElemType A[], int n, ElemType *, int) { IntroSort(A, n); }, 1 << 30},
+    {"IntroSort+Block", [](ElemType A[], int n, ElemType *, int) { IntroSort(A, n, BlockPartition); }, 1 << 30},
+    {"ParallelQuickSort", [](ElemType A[], int n, ElemType *, int t) { ParallelQuickSort(A, n, t); }, 1 << 30},
+    {"QuickSort3Way", [](ElemType A[], int n, ElemType *, int) { QuickSort3Way(A, 1, n); }, 1 << 30},
+    {"MergeSortBuffered", [](ElemType A[], int n, ElemType B[], int) { MergeSortBuffered(A + 1, n, B); }, 1 << 30},
+    {"AdaptiveSort", [](ElemType A[], int n, ElemType *, int) { AdaptiveSort(A + 1, n); }, 1 << 30},
+    {"RadixSort", [](ElemType A[], int n, ElemType B[], int) { RadixSort(A + 1, n, B); }, 1 << 30},
+    {"RadixSortInPlace", [](ElemType A[], int n, ElemType *, int) { RadixSortInPlace(A + 1, n); }, 1 << 30},
+    {"ParallelRadixSort", [](ElemType A[], int n, ElemType B[], int t) { ParallelRadixSort(A + 1, n, B, t); }, 1 << 30},
+    {"ParallelSampleSort", [](ElemType A[], int n, ElemType B[], int t) { ParallelSampleSort(A + 1, n, B, t); }, 1 << 30},
+};
+
+static const char *DISTS[] = {"random",     "sorted",   "reversed", "few-unique",
+                              "organ-pipe", "sawtooth", "zipf", "nearly-sorted"};
+static const int NSORTS = sizeof(SORTS) / sizeof(SortEntry);
+static const int NDISTS = sizeof(DISTS) / sizeof(const char *);
+
+static unsigned long long rng = 88172645463325252ULL;
+static unsigned int NextRand() { // xorshift64，比rand()快且范围是32位
+  rng ^= rng << 13;
+  rng ^= rng >> 7;
+  rng ^= rng << 17;
+  return (unsigned int)(rng >> 16);
+}
+
+static void Generate(ElemType A[], int n, int dist) { // 生成A[1..n]
+  switch (dist) {
+  case 0: // random
+    for (int i = 1; i <= n; i++)
+      A[i] = (ElemType)NextRand();
+    break;
+  case 1: // sorted
+    for (int i = 1; i <= n; i++)
+      A[i] = i;
+    break;
+  case 2: // reversed
+    for (int i = 1; i <= n; i++)
+      A[i] = n - i;
+    break;
+  case 3: // few-unique
+    for (int i = 1; i <= n; i++)
+      A[i] = NextRand() % 8;
+    break;
+  case 4: // organ-pipe
+    for (int i = 1; i <= n; i++)
+      A[i] = i <= n / 2 ? i : n - i;
+    break;
+  case 5: { // sawtooth
+    int tooth = (int)sqrt((double)n) + 1;
+    for (int i = 1; i <= n; i++)
+      A[i] = i % tooth;
+    break;
+  }
+  case 6: { // zipf，s=1，取值1..m，值k出现的概率与1/k成正比
+    int m = n < 1000000 ? n : 1000000;
+    std::vector<double> cdf(m);
+    double sum = 0;
+    for (int k = 0; k < m; k++) {
+      sum += 1.0 / (k + 1);
+      cdf[k] = sum;
+    }
+    for (int i = 1; i <= n; i++) {
+      double u = (NextRand() / 4294967296.0) * sum;
+      int l = 0, r = m - 1;
+      while (l < r) {
+        int mid = (l + r) / 2;
+        if (cdf[mid] < u)
+          l = mid + 1;
+        else
+          r = mid;
+      }
+      A[i] = l + 1;
+    }
+    break;
+  }
+  case 7: // nearly-sorted，有序序列中约1%的位置和后面16个以内的元素交换
+    for (int i = 1; i <= n; i++)
+      A[i] = i;
+    for (int i = 1; i + 16 <= n; i++)
+      if (NextRand() % 100 == 0) {
+        int j = i + 1 + NextRand() % 16;
+        ElemType tp = A[i];
+        A[i] = A[j];
+        A[j] = tp;
+      }
+    break;
+  }
+}
+
+typedef struct {
+  double nsPerElem;
+  SortStats stats; // 第一次排序的计数，未插桩或无硬件计数器时对应字段为-1
+  long peakRssKB;
+  int ok;
+} BenchResult;
+
+static BenchResult RunCase(const SortEntry &s, int dist, int n, int threads) {
+  BenchResult res;
+  res.nsPerElem = 0;
+  res.peakRssKB = 0;
+  res.ok = 1;
+  std::vector<ElemType> data(n + 1), A(n + 1), B(n);
+  Generate(data.data(), n, dist);
+
+  // 小规模重复多次：直到累计排序约10^6个元素或耗时超过20ms
+  int maxReps = 1000000 / n, reps = 0;
+  double total = 0;
+  while (reps == 0 || (reps < maxReps && total < 2e7)) {
+    reps++;
+    A = data;
+    if (reps == 1) { // 计数只取第一次
+      res.stats = ProfileSort([&]() { s.run(A.data(), n, B.data(), threads); });
+      total += res.stats.ns;
+    } else {
+      std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+      s.run(A.data(), n, B.data(), threads);
+      std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+      total += std::chrono::duration<double, std::nano>(t1 - t0).count();
+    }
+    if (!isSorted(&A[1], n))
+      res.ok = 0;
+  }
+  res.nsPerElem = total / reps / n;
+
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  res.peakRssKB = ru.ru_maxrss;
+  return res;
+}
+
+static bool RunIsolated(const SortEntry &s, int dist, int n, int threads,
+                        BenchResult &res) { // 在子进程中测试，通过管道取回结果
+  int fd[2];
+  if (pipe(fd) != 0)
+    return false;
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0)
+    return false;
+  if (pid == 0) {
+    close(fd[0]);
+    BenchResult r = RunCase(s, dist, n, threads);
+    ssize_t w = write(fd[1], &r, sizeof(r));
+    _exit(w == (ssize_t)sizeof(r) ? 0 : 1);
+  }
+  close(fd[1]);
+  ssize_t got = read(fd[0], &res, sizeof(res));
+  close(fd[0]);
+  int status;
+  waitpid(pid, &status, 0);
+  return got == (ssize_t)sizeof(res) && WIFEXITED(status) &&
+         WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char **argv) {
+  long long minN = 10, maxN = 1000000;
+  int threads = 0;
+  bool json = false;
+  std::string onlySort, onlyDist;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.compare(0, 8, "--max-n=") == 0)
+      maxN = atoll(arg.c_str() + 8);
+    else if (arg.compare(0, 8, "--min-n=") == 0)
+      minN = atoll(arg.c_str() + 8);
+    else if (arg.compare(0, 10, "--threads=") == 0)
+      threads = atoi(arg.c_str() + 10);
+    else if (arg == "--format=json")
+      json = true;
+    else if (arg == "--format=csv")
+      json = false;
+    else if (arg.compare(0, 7, "--sort=") == 0)
+      onlySort = arg.substr(7);
+    else if (arg.compare(0, 7, "--dist=") == 0)
+      onlyDist = arg.substr(7);
+    else {
+      fprintf(stderr,
+              "usage: %s [--min-n=N] [--max-n=N] [--format=csv|json] "
+              "[--sort=NAME] [--dist=NAME] [--threads=N]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+  if (minN < 1 || maxN > INT_MAX) { // n从minN起每次乘10，为0时不会前进；排序的长度为int
+    fprintf(stderr, "%s: need 1 <= min-n and max-n <= %d\n", argv[0], INT_MAX);
+    return 1;
+  }
+
+  if (json)
+    printf("[\n");
+  else
+    printf("sort,dist,n,ns_per_elem,comparisons,moves,cycles,instructions,"
+           "branch_misses,llc_misses,peak_rss_kb,ok\n");
+  bool first = true;
+  for (int si = 0; si < NSORTS; si++) {
+    const SortEntry &s = SORTS[si];
+    if (!onlySort.empty() && onlySort != s.name)
+      continue;
+    for (int d = 0; d < NDISTS; d++) {
+      if (!onlyDist.empty() && onlyDist != DISTS[d])
+        continue;
+      for (long long n = minN; n <= maxN && n <= s.maxN; n *= 10) {
+        BenchResult r;
+        if (!RunIsolated(s, d, (int)n, threads, r)) {
+          fprintf(stderr, "%s/%s/%lld: child failed\n", s.name, DISTS[d], n);
+          continue;
+        }
+        const SortStats &st = r.stats;
+        if (json) {
+          printf("%s  {\"sort\": \"%s\", \"dist\": \"%s\", \"n\": %lld, "
+                 "\"ns_per_elem\": %.3f, \"comparisons\": %lld, "
+                 "\"moves\": %lld, \"cycles\": %lld, \"instructions\": %lld, "
+                 "\"branch_misses\": %lld, \"llc_misses\": %lld, "
+                 "\"peak_rss_kb\": %ld, \"ok\": %s}",
+                 first ? "" : ",\n", s.name, DISTS[d], n, r.nsPerElem,
+                 st.comparisons, st.moves, st.cycles, st.instructions,
+                 st.branchMisses, st.llcMisses, r.peakRssKB,
+                 r.ok ? "true" : "false");
+        } else {
+          printf("%s,%s,%lld,%.3f,%lld,%lld,%lld,%lld,%lld,%lld,%ld,%d\n",
+                 s.name, DISTS[d], n, r.nsPerElem, st.comparisons, st.moves,
+                 st.cycles, st.instructions, st.branchMisses, st.llcMisses,
+                 r.peakRssKB, r.ok);
+        }
+        first = false;
+        fflush(stdout);
+      }
+    }
+  }
+  if (json)
+    printf("\n]\n");
+  return 0;
+}
@@ -0,0 +1,139 @@
+#include "PriorityQueue.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <gtest/gtest.h>
+#include <vector>
+
+template <int D> static void CheckPushPop() {
+  srand(D);
+  PriorityQueue<int, D> q;
+  std::vector<int> all;
+  for (int round = 0; round < 20; round++) { // interleave pushes and pops
+    for (int i = 0; i < 500; i++) {
+      int x = rand() % 1000 - 500;
+      q.Push(x);
+      all.push_back(x);
+    }
+    std::sort(all.begin(), all.end());
+    for (int i = 0; i < 200; i++) {
+      ASSERT_EQ(all.front(), q.Top());
+      ASSERT_EQ(all.front(), q.Pop());
+      all.erase(all.begin());
+    }
+    ASSERT_EQ((int)all.size(), q.Size());
+  }
+  while (!q.Empty()) {
+    ASSERT_EQ(all.front(), q.Pop());
+    all.erase(all.begin());
+  }
+}
+
+TEST(PriorityQueueTest, PushPop_AllArities) {
+  CheckPushPop<2>();
+  CheckPushPop<4>();
+  CheckPushPop<8>();
+}
+
+TEST(PriorityQueueTest, MaxHeapWithComparator) {
+  PriorityQueue<double, 4, std::greater<double>> q;
+  double in[] = {0.5, -3, 2.25, 9, 1};
+  q.Heapify(in, 5);
+  double expect[] = {9, 2.25, 1, 0.5, -3};
+  for (double x : expect)
+    EXPECT_EQ(x, q.Pop());
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(PriorityQueueTest, DecreaseKey_Dijkstra) {
+  // shortest paths on a random graph, checked against Bellman-Ford
+  const int n = 300;
+  srand(7);
+  std::vector<std::vector<std::pair<int, int>>> adj(n);
+  for (int i = 0; i < 3000; i++)
+    adj[rand() % n].push_back({rand() % n, rand() % 100 + 1});
+
+  const long long INF = 1LL << 60;
+  std::vector<long long> expect(n, INF);
+  expect[0] = 0;
+  for (int it = 0; it < n; it++)
+    for (int u = 0; u < n; u++)
+      for (auto &e : adj[u])
+        if (expect[u] < INF && expect[u] + e.second < expect[e.first])
+          expect[e.first] = expect[u] + e.second;
+
+  typedef std::pair<long long, int> Item; // (distance, vertex)
+  PriorityQueue<Item> q;
+  std::vector<long long> dist(n, INF);
+  std::vector<PriorityQueue<Item>::Handle> handle(n, -1);
+  std::vector<bool> done(n, false);
+  dist[0] = 0;
+  handle[0] = q.Push(Item(0, 0));
+  while (!q.Empty()) {
+    int u = q.Pop().second;
+    done[u] = true;
+    for (auto &e : adj[u]) {
+      int v = e.first;
+      long long d = dist[u] + e.second;
+      if (done[v] || d >= dist[v])
+        continue;
+      dist[v] = d;
+      if (handle[v] >= 0 && q.Contains(handle[v]))
+        q.DecreaseKey(handle[v], Item(d, v));
+      else
+        handle[v] = q.Push(Item(d, v));
+    }
+  }
+  EXPECT_EQ(expect, dist);
+}
+
+TEST(PriorityQueueTest, HeapifyThenPush) {
+  std::vector<int> in(1000);
+  for (int i = 0; i < 1000; i++)
+    in[i] = (i * 7919) % 1000;
+  PriorityQueue<int, 8> q;
+  q.Push(-1); // replaced by Heapify
+  q.Heapify(in.data(), 1000);
+  EXPECT_EQ(1000, q.Size());
+  PriorityQueue<int, 8>::Handle h = q.Push(5000);
+  q.DecreaseKey(h, -10);
+  EXPECT_EQ(-10, q.Pop());
+  for (int i = 0; i < 1000; i++)
+    ASSERT_EQ(i, q.Pop());
+}
+
+TEST(PriorityQueueTest, StaleHandleRejected) {
+  PriorityQueue<int> q;
+  PriorityQueue<int>::Handle a = q.Push(10);
+  PriorityQueue<int>::Handle b = q.Push(20);
+  EXPECT_EQ(10, q.Pop());
+  PriorityQueue<int>::Handle c = q.Push(30); // reuses a's slot
+  EXPECT_FALSE(q.Contains(a));
+  EXPECT_TRUE(q.Contains(b));
+  EXPECT_TRUE(q.Contains(c));
+  EXPECT_NE(a, c);
+  q.DecreaseKey(c, 5);
+  EXPECT_EQ(5, q.Pop());
+  EXPECT_EQ(20, q.Pop());
+
+  int data[] = {3, 1, 2};
+  PriorityQueue<int>::Handle h[3];
+  q.Heapify(data, 3, h);
+  EXPECT_FALSE(q.Contains(b)); // Clear by Heapify invalidates old handles
+  q.DecreaseKey(h[0], 0);
+  EXPECT_EQ(0, q.Pop());
+  q.Clear();
+  EXPECT_FALSE(q.Contains(h[1]));
+  EXPECT_FALSE(q.Contains(-1));
+}
+
+TEST(PriorityQueueTest, SiblingsShareCacheLine) {
+  PriorityQueue<int> q;
+  for (int i = 0; i < 100; i++)
+    q.Push(i);
+  // children of the root are the first four slots after it
+  const int *root = &q.Top();
+  uintptr_t first = (uintptr_t)(root + 2); // Entry is {int, int}
+  EXPECT_EQ(0u, first % 32);
+}
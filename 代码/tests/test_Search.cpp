@@ -1,7 +1,13 @@
 #include "Search.h"
+#include <algorithm>
+#include <climits>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <memory>
+#include <set>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 
 class SearchTest : public ::testing::Test {
 protected:
@@ -24,7 +30,7 @@ protected:
 
   void TearDown() override {
     delete[] ST.elem;
-    // Note: Should implement BST cleanup in real code
+    BSTDestroy(T);
   }
 
   SSTable ST;
@@ -69,6 +75,421 @@ TEST_F(SearchTest, BinarySearchRecursion_NotFound) {
   EXPECT_EQ(0, BinarySearchRecursion(ST, 100, 1, 5));
 }
 
+// Test Eytzinger layout search against BinarySearch
+TEST_F(SearchTest, Eytzinger_MatchesBinarySearch) {
+  srand(20);
+  for (int n : {1, 2, 3, 7, 8, 15, 16, 17, 100, 1000, 4097}) {
+    std::vector<ElemType> a(n);
+    for (int &x : a)
+      x = rand() % (2 * n) - n; // duplicates included
+    std::sort(a.begin(), a.end());
+    SSTable S = {a.data(), n};
+    EytzingerTable E;
+    ASSERT_TRUE(EytzingerBuild(S, E));
+    for (int key = -n - 2; key <= n + 2; key++) {
+      ASSERT_EQ(BinarySearch(S, key), EytzingerSearch(E, key)) << n << " " << key;
+      ASSERT_EQ(std::lower_bound(a.begin(), a.end(), key) - a.begin(),
+                EytzingerLowerBound(E, key));
+    }
+    EXPECT_EQ(0, EytzingerLowerBound(E, INT_MIN));
+    EXPECT_EQ(n, EytzingerLowerBound(E, INT_MAX));
+    EytzingerDestroy(E);
+  }
+}
+
+TEST_F(SearchTest, Eytzinger_Empty) {
+  SSTable S = {ST.elem, 0};
+  EytzingerTable E;
+  ASSERT_TRUE(EytzingerBuild(S, E));
+  EXPECT_EQ(-1, EytzingerSearch(E, 1));
+  EXPECT_EQ(0, EytzingerLowerBound(E, 1));
+  EytzingerDestroy(E);
+}
+
+// Test static B+-tree (S-tree)
+TEST_F(SearchTest, STree_Bounds) {
+  srand(21);
+  for (int n : {1, 15, 16, 17, 272, 273, 4625, 100000}) {
+    for (int range : {3, 4 * n}) { // long runs of duplicates / mostly distinct
+      std::vector<ElemType> a(n);
+      for (int &x : a)
+        x = rand() % range;
+      std::sort(a.begin(), a.end());
+      SSTable S = {a.data(), n};
+      STree T;
+      ASSERT_TRUE(STreeBuild(S, T));
+      for (int q = 0; q < 2000; q++) {
+        int key = rand() % (range + 2) - 1;
+        ASSERT_EQ(std::lower_bound(a.begin(), a.end(), key) - a.begin(),
+                  STreeLowerBound(T, key)) << n << " " << key;
+        ASSERT_EQ(std::upper_bound(a.begin(), a.end(), key) - a.begin(),
+                  STreeUpperBound(T, key));
+        ASSERT_EQ(BinarySearch(S, key), STreeSearch(T, key));
+      }
+      EXPECT_EQ(0, STreeLowerBound(T, INT_MIN));
+      EXPECT_EQ(n, STreeUpperBound(T, INT_MAX));
+      STreeDestroy(T);
+    }
+  }
+}
+
+TEST_F(SearchTest, STree_RangeAndEmpty) {
+  std::vector<ElemType> a;
+  for (int i = 0; i < 1000; i++)
+    a.push_back(i / 3); // 0,0,0,1,1,1,...
+  SSTable S = {a.data(), (int)a.size()};
+  STree T;
+  ASSERT_TRUE(STreeBuild(S, T));
+  STreeIter it = STreeRange(T, 10, 12);
+  std::vector<ElemType> got;
+  ElemType key;
+  while (STreeNext(it, key))
+    got.push_back(key);
+  EXPECT_EQ(std::vector<ElemType>({10, 10, 10, 11, 11, 11, 12, 12, 12}), got);
+  it = STreeRange(T, 12, 10); // empty range
+  EXPECT_FALSE(STreeNext(it, key));
+  STreeDestroy(T);
+
+  SSTable E = {ST.elem, 0};
+  ASSERT_TRUE(STreeBuild(E, T));
+  EXPECT_EQ(0, STreeLowerBound(T, 5));
+  EXPECT_EQ(-1, STreeSearch(T, 5));
+  STreeDestroy(T);
+}
+
+// Test dynamic B+-tree against std::set
+TEST_F(SearchTest, BPTree_RandomOps) {
+  for (int order : {3, 4, 5, 32}) {
+    srand(order);
+    BPTree B;
+    ASSERT_TRUE(BPTreeInit(B, order));
+    std::set<KeyType> ref;
+    for (int round = 0; round < 20; round++) {
+      for (int i = 0; i < 500; i++) {
+        KeyType key = rand() % 2000;
+        if (rand() % 3) // grow on average, but delete often enough to merge nodes
+          ASSERT_EQ(ref.insert(key).second, BPTreeInsert(B, key));
+        else
+          ASSERT_EQ(ref.erase(key) == 1, BPTreeDelete(B, key));
+      }
+      ASSERT_TRUE(BPTreeIsValid(B)) << "order " << order << " round " << round;
+      ASSERT_EQ((int)ref.size(), B.size);
+      for (KeyType key = -1; key <= 2000; key += 7)
+        ASSERT_EQ(ref.count(key) == 1, BPTreeSearch(B, key));
+    }
+    for (KeyType key : std::vector<KeyType>(ref.begin(), ref.end())) // delete everything
+      ASSERT_TRUE(BPTreeDelete(B, key));
+    EXPECT_TRUE(BPTreeIsValid(B));
+    EXPECT_EQ(1, B.height);
+    BPTreeDestroy(B);
+  }
+}
+
+TEST_F(SearchTest, BPTree_AscendingStaysShallow) {
+  // Ascending keys turn the BST into a list; the B+-tree height stays logarithmic
+  BPTree B;
+  ASSERT_TRUE(BPTreeInit(B, 16));
+  for (KeyType key = 0; key < 100000; key++)
+    ASSERT_TRUE(BPTreeInsert(B, key));
+  EXPECT_TRUE(BPTreeIsValid(B));
+  EXPECT_LE(B.height, 6);
+  EXPECT_TRUE(BPTreeSearch(B, 99999));
+  BPTreeDestroy(B);
+}
+
+TEST_F(SearchTest, BPTree_BulkLoadAndRange) {
+  for (int order : {3, 4, 32}) {
+    for (int n : {0, 1, 3, 4, 5, 100, 10000}) {
+      std::vector<KeyType> keys;
+      for (int i = 0; i < n; i++)
+        keys.push_back(i / 2 * 3); // duplicates are dropped
+      BPTree B;
+      ASSERT_TRUE(BPTreeInit(B, order));
+      ASSERT_TRUE(BPTreeInsert(B, -5)); // replaced by the bulk load
+      ASSERT_TRUE(BPTreeBulkLoad(B, keys.data(), n));
+      ASSERT_TRUE(BPTreeIsValid(B)) << order << " " << n;
+      EXPECT_EQ((n + 1) / 2, B.size);
+      EXPECT_FALSE(BPTreeSearch(B, -5));
+
+      BPTreeIter it = BPTreeLowerBound(B, 10);
+      std::vector<KeyType> got;
+      KeyType key;
+      while (BPTreeNext(it, key) && key <= 30)
+        got.push_back(key);
+      std::vector<KeyType> expect;
+      for (KeyType k = 12; k <= 30 && k <= (n - 1) / 2 * 3; k += 3)
+        expect.push_back(k);
+      EXPECT_EQ(expect, got);
+
+      ASSERT_TRUE(BPTreeInsert(B, 1)); // still a normal tree afterwards
+      ASSERT_TRUE(BPTreeIsValid(B));
+      BPTreeDestroy(B);
+    }
+  }
+  BPTree B;
+  ASSERT_TRUE(BPTreeInit(B));
+  KeyType unsorted[] = {3, 1, 2};
+  EXPECT_FALSE(BPTreeBulkLoad(B, unsorted, 3));
+  BPTreeDestroy(B);
+}
+
+TEST_F(SearchTest, BPTree_PrintBigger) {
+  BPTree B;
+  ASSERT_TRUE(BPTreeInit(B, 3));
+  ElemType keys[] = {50, 30, 70, 20, 40, 60, 80};
+  for (ElemType k : keys)
+    BPTreeInsert(B, k);
+  testing::internal::CaptureStdout();
+  BPTreePrintBigger(B, 60);
+  EXPECT_EQ("80 70 60 ", testing::internal::GetCapturedStdout());
+  BPTreeDestroy(B);
+}
+
+// Test Swiss-table style hash map against std::unordered_map
+TEST_F(SearchTest, Hash_RandomOpsThroughGrowth) {
+  srand(7);
+  HashTable H;
+  ASSERT_TRUE(HashInit(H));
+  EXPECT_EQ(1, H.cur.groups);
+  std::unordered_map<KeyType, ElemType> ref;
+  for (int round = 0; round < 40; round++) {
+    for (int i = 0; i < 2000; i++) {
+      KeyType key = rand() % 30000 - 15000; // negative keys too
+      if (rand() % 4) {
+        bool isNew = ref.find(key) == ref.end();
+        ref[key] = i;
+        ASSERT_EQ(isNew, HashInsert(H, key, i));
+      } else {
+        ASSERT_EQ(ref.erase(key) == 1, HashDelete(H, key));
+      }
+      ASSERT_EQ((int)ref.size(), H.size);
+    }
+    for (KeyType key = -15001; key <= 15000; key += 3) { // checked mid-migration as well
+      ElemType value = -1;
+      auto it = ref.find(key);
+      ASSERT_EQ(it != ref.end(), HashFind(H, key, &value)) << key;
+      if (it != ref.end()) {
+        ASSERT_EQ(it->second, value);
+      }
+    }
+  }
+  EXPECT_GE(H.cur.groups, 1024);
+  for (auto &kv : std::vector<std::pair<KeyType, ElemType>>(ref.begin(), ref.end()))
+    ASSERT_TRUE(HashDelete(H, kv.first));
+  EXPECT_EQ(0, H.size);
+  EXPECT_FALSE(HashFind(H, 0));
+  HashDestroy(H);
+}
+
+TEST_F(SearchTest, Hash_DeleteKeepsProbeChains) {
+  // A full table at the maximum load forces long group chains; deleting out of
+  // the middle of a chain must not hide the keys behind it
+  HashTable H;
+  ASSERT_TRUE(HashInit(H, 1000, 15.0 / 16));
+  int groups = H.cur.groups;
+  int n = (int)(groups * HASH_GROUP * 15.0 / 16);
+  for (KeyType key = 0; key < n; key++)
+    ASSERT_TRUE(HashInsert(H, key, key * 2));
+  ASSERT_EQ(groups, H.cur.groups); // no growth yet
+  for (KeyType key = 0; key < n; key += 2)
+    ASSERT_TRUE(HashDelete(H, key));
+  for (KeyType key = 0; key < n; key++) {
+    ElemType value;
+    ASSERT_EQ(key % 2 == 1, HashFind(H, key, &value)) << key;
+    if (key % 2 == 1) {
+      ASSERT_EQ(key * 2, value);
+    }
+  }
+  EXPECT_FALSE(HashInsert(H, 1, 5)); // existing key is updated
+  ElemType value;
+  ASSERT_TRUE(HashFind(H, 1, &value));
+  EXPECT_EQ(5, value);
+  HashDestroy(H);
+}
+
+TEST_F(SearchTest, Hash_FindMany) {
+  HashTable H;
+  ASSERT_TRUE(HashInit(H, 0, 2.0)); // out-of-range load factor falls back to the default
+  EXPECT_DOUBLE_EQ(HASH_MAX_LOAD, H.maxLoad);
+  for (KeyType key = 0; key < 5000; key++)
+    HashInsert(H, key * 3, key);
+  std::vector<KeyType> keys;
+  for (KeyType key = -10; key < 15010; key++)
+    keys.push_back(key);
+  int n = (int)keys.size();
+  std::unique_ptr<bool[]> found(new bool[n]);
+  std::vector<ElemType> values(n, -1);
+  HashFindMany(H, keys.data(), n, found.get(), values.data());
+  for (int i = 0; i < n; i++) {
+    bool expect = keys[i] >= 0 && keys[i] < 15000 && keys[i] % 3 == 0;
+    ASSERT_EQ(expect, found[i]) << keys[i];
+    if (expect) {
+      ASSERT_EQ(keys[i] / 3, values[i]);
+    }
+  }
+  HashFindMany(H, keys.data(), 0, found.get());
+  HashDestroy(H);
+}
+
+// Test order-statistic tree (AVL on BSTNode)
+static int CheckOST(BiTree T) { // returns height, fails the test on a broken invariant
+  if (T == NULL)
+    return 0;
+  int hl = CheckOST(T->lchild), hr = CheckOST(T->rchild);
+  EXPECT_LE(abs(hl - hr), 1);
+  EXPECT_EQ(std::max(hl, hr) + 1, T->height);
+  int cl = T->lchild ? T->lchild->count : 0, cr = T->rchild ? T->rchild->count : 0;
+  EXPECT_EQ(cl + cr + T->dup, T->count);
+  return T->height;
+}
+
+TEST_F(SearchTest, OST_RankSelectWithDuplicates) {
+  srand(23);
+  BiTree R = NULL;
+  std::multiset<ElemType> ref;
+  for (int round = 0; round < 10; round++) {
+    for (int i = 0; i < 2000; i++) {
+      ElemType key = rand() % 500; // many duplicates
+      if (rand() % 4) {
+        ASSERT_TRUE(OSTInsert(R, key));
+        ref.insert(key);
+      } else {
+        bool had = ref.count(key) > 0;
+        if (had)
+          ref.erase(ref.find(key));
+        ASSERT_EQ(had, OSTDelete(R, key));
+      }
+    }
+    CheckOST(R);
+    ASSERT_TRUE(IsBST(R));
+    std::vector<ElemType> sorted(ref.begin(), ref.end());
+    ASSERT_EQ((int)sorted.size(), R ? R->count : 0);
+    for (int k = 1; k <= (int)sorted.size(); k += 13)
+      ASSERT_EQ(sorted[k - 1], KthSmall(R, k)->data) << k;
+    for (ElemType key = -1; key <= 501; key += 5)
+      ASSERT_EQ(std::lower_bound(sorted.begin(), sorted.end(), key) - sorted.begin(),
+                OSTRank(R, key));
+  }
+  EXPECT_EQ(nullptr, KthSmall(R, 0));
+  EXPECT_EQ(nullptr, KthSmall(R, R->count + 1));
+  BSTDestroy(R);
+  EXPECT_EQ(nullptr, R);
+}
+
+TEST_F(SearchTest, OST_AscendingInsertIsBalanced) {
+  BiTree R = NULL;
+  const int n = 1000000;
+  for (int i = 0; i < n; i++)
+    ASSERT_TRUE(OSTInsert(R, i));
+  EXPECT_LE(R->height, 29); // AVL bound 1.44*log2(n)
+  EXPECT_GE(R->height, GetLevel(R, 0));
+  EXPECT_LT(0, GetLevel(R, 0));
+  EXPECT_EQ(0, GetLevel(R, n));
+  EXPECT_EQ(123456, KthSmall(R, 123457)->data);
+  EXPECT_EQ(n / 2, OSTRank(R, n / 2));
+  for (int i = 0; i < n; i += 2)
+    ASSERT_TRUE(OSTDelete(R, i));
+  CheckOST(R);
+  EXPECT_EQ(n / 2, R->count);
+  EXPECT_EQ(1001, KthSmall(R, 501)->data);
+  BSTDestroy(R);
+}
+
+static void CollectSlabs(BiTree T, std::set<uintptr_t> &slabs) {
+  if (T == NULL)
+    return;
+  slabs.insert((uintptr_t)T & ~(uintptr_t)(BST_SLAB_BYTES - 1));
+  CollectSlabs(T->lchild, slabs);
+  CollectSlabs(T->rchild, slabs);
+}
+
+TEST_F(SearchTest, BSTPool_DenseSlabsAndReuse) {
+  const int n = 2000;
+  int perSlab = (BST_SLAB_BYTES - 64) / (int)sizeof(BSTNode);
+  BiTree A = NULL, B = NULL;
+  for (int i = 0; i < n; i++) { // interleaved inserts still give each tree its own slabs
+    ASSERT_TRUE(OSTInsert(A, i));
+    ASSERT_TRUE(BSTInsert(B, (i * 7919) % n));
+  }
+  std::set<uintptr_t> slabsA, slabsB;
+  CollectSlabs(A, slabsA);
+  CollectSlabs(B, slabsB);
+  int expectSlabs = (n + perSlab - 1) / perSlab;
+  EXPECT_EQ(expectSlabs, (int)slabsA.size());
+  EXPECT_EQ(expectSlabs, (int)slabsB.size());
+  for (uintptr_t s : slabsA)
+    EXPECT_EQ(0u, slabsB.count(s));
+
+  for (int i = 0; i < n; i += 2) // freed nodes are reused before new slabs are cut
+    ASSERT_TRUE(OSTDelete(A, i));
+  for (int i = n; i < n + n / 2; i++)
+    ASSERT_TRUE(OSTInsert(A, i));
+  slabsA.clear();
+  CollectSlabs(A, slabsA);
+  EXPECT_EQ(expectSlabs, (int)slabsA.size());
+  CheckOST(A);
+
+  BSTDestroy(B); // A is unaffected
+  EXPECT_EQ(nullptr, B);
+  EXPECT_EQ(n, A->count);
+  for (int i = 1; i < n + n / 2; i++) {
+    if (i >= n || i % 2 == 1) {
+      ASSERT_TRUE(OSTDelete(A, i));
+    }
+  }
+  EXPECT_EQ(nullptr, A); // deleting every node releases the pool as well
+  BSTDestroy(A);
+}
+
+TEST_F(SearchTest, BSTPool_HandBuiltTreeStillWorks) {
+  // Nodes not allocated by the pool are inserted into and freed with malloc/free
+  BiTree H = (BiTree)malloc(sizeof(BSTNode));
+  H->data = 50;
+  H->lchild = H->rchild = NULL;
+  H->count = H->height = H->dup = 1;
+  for (ElemType key : {30, 70, 20, 40})
+    ASSERT_TRUE(BSTInsert(H, key));
+  ASSERT_TRUE(OSTInsert(H, 60));
+  EXPECT_TRUE(IsBST(H));
+  ASSERT_TRUE(OSTDelete(H, 20));
+  EXPECT_EQ(5, H->count);
+  BSTDestroy(H);
+  EXPECT_EQ(nullptr, H);
+}
+
+TEST_F(SearchTest, BSTPool_TreesOnSeparateThreads) {
+  // Separate trees may be built and destroyed concurrently
+  std::vector<std::thread> workers;
+  std::vector<int> ok(4, 0);
+  for (int t = 0; t < 4; t++) {
+    workers.emplace_back([t, &ok]() {
+      for (int round = 0; round < 5; round++) {
+        BiTree R = NULL;
+        for (int i = 0; i < 5000; i++)
+          OSTInsert(R, (i * 7919 + t) % 5000);
+        for (int i = 0; i < 5000; i += 2)
+          OSTDelete(R, i);
+        bool good = R != NULL && R->count == 2500 && IsBST(R) && KthSmall(R, 1)->data == 1;
+        BSTDestroy(R);
+        ok[t] += good;
+      }
+    });
+  }
+  for (std::thread &w : workers)
+    w.join();
+  EXPECT_EQ(std::vector<int>(4, 5), ok);
+}
+
+TEST_F(SearchTest, KthSmall_BSTInsertMaintainsCount) {
+  // keys {50, 30, 70, 20, 40, 60, 80} from the fixture
+  EXPECT_EQ(7, T->count);
+  EXPECT_EQ(20, KthSmall(T, 1)->data);
+  EXPECT_EQ(50, KthSmall(T, 4)->data);
+  EXPECT_EQ(80, KthSmall(T, 7)->data);
+  EXPECT_EQ(nullptr, KthSmall(T, 8));
+  EXPECT_EQ(3, OSTRank(T, 45));
+}
+
 // Test BST_Search function
 TEST_F(SearchTest, BST_Search_Found) {
   BSTNode *result = BST_Search(T, 50);
@@ -101,6 +522,7 @@ TEST_F(SearchTest, BSTInsert_NewNode) {
 
   EXPECT_TRUE(BSTInsert(testTree, 5));
   EXPECT_TRUE(BSTInsert(testTree, 15));
+  BSTDestroy(testTree);
 }
 
 TEST_F(SearchTest, BSTInsert_DuplicateNode) {
@@ -239,4 +661,7 @@ TEST_F(SearchTest, IntegrationTest_BST) {
 
   // Test BST validation
   EXPECT_TRUE(IsBST(testTree));
+
+  BSTDestroy(testTree);
+  EXPECT_EQ(nullptr, testTree);
 }
\ No newline at end of file
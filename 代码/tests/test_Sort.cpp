@@ -0,0 +1,588 @@
+#include "Sort.h"
+#include "MergeKernel.h"
+#include <climits>
+#include <algorithm>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+class SortTest : public ::testing::Test {
+protected:
+  // Build a 1-based array (A[0] reserved) of size n with the given pattern
+  std::vector<ElemType> Make(int n, int pattern) {
+    std::vector<ElemType> A(n + 1, 0);
+    srand(12345);
+    for (int i = 1; i <= n; i++) {
+      switch (pattern) {
+      case 0: // random
+        A[i] = rand() - RAND_MAX / 2;
+        break;
+      case 1: // sorted
+        A[i] = i;
+        break;
+      case 2: // reversed
+        A[i] = n - i;
+        break;
+      case 3: // few unique
+        A[i] = rand() % 4;
+        break;
+      case 4: // organ pipe
+        A[i] = i <= n / 2 ? i : n - i;
+        break;
+      }
+    }
+    return A;
+  }
+
+  void ExpectSorted1(std::vector<ElemType> A, std::vector<ElemType> expect) {
+    std::sort(expect.begin() + 1, expect.end());
+    for (size_t i = 1; i < A.size(); i++)
+      ASSERT_EQ(expect[i], A[i]) << "at index " << i;
+  }
+};
+
+// Test IntroSort function
+TEST_F(SortTest, IntroSort_Patterns) {
+  for (int pattern = 0; pattern < 5; pattern++) {
+    for (int n : {0, 1, 2, 15, 16, 17, 100, 1000}) {
+      std::vector<ElemType> A = Make(n, pattern), B = A;
+      IntroSort(A.data(), n);
+      ExpectSorted1(A, B);
+    }
+  }
+}
+
+TEST_F(SortTest, IntroSort_LargeAdversarial) {
+  // Sorted and reversed inputs used to overflow the stack in QuickSort
+  for (int pattern = 1; pattern < 5; pattern++) {
+    std::vector<ElemType> A = Make(500000, pattern), B = A;
+    IntroSort(A.data(), 500000);
+    ExpectSorted1(A, B);
+  }
+}
+
+TEST_F(SortTest, IntroSort_KeepsSentinelSlot) {
+  std::vector<ElemType> A = Make(1000, 0);
+  A[0] = 42;
+  IntroSort(A.data(), 1000);
+  EXPECT_TRUE(isSorted(&A[1], 1000));
+  EXPECT_EQ(42, A[0]); // A[0] is not part of the data and must be left alone
+}
+
+// Test ParallelQuickSort function
+TEST_F(SortTest, ParallelQuickSort_Patterns) {
+  for (int threads : {1, 2, 4, 8}) {
+    for (int pattern = 0; pattern < 5; pattern++) {
+      std::vector<ElemType> A = Make(300000, pattern), B = A;
+      ParallelQuickSort(A.data(), 300000, threads);
+      ExpectSorted1(A, B);
+    }
+  }
+}
+
+TEST_F(SortTest, ParallelQuickSort_SmallAndDefaultThreads) {
+  for (int n : {0, 1, 2, 100, 20000}) {
+    std::vector<ElemType> A = Make(n, 0), B = A;
+    ParallelQuickSort(A.data(), n);
+    ExpectSorted1(A, B);
+  }
+}
+
+// Test MergeSortBuffered function
+TEST_F(SortTest, MergeSortBuffered_ReusesBuffer) {
+  std::vector<ElemType> B(100000);
+  for (int pattern = 0; pattern < 5; pattern++) {
+    for (int n : {0, 1, 31, 32, 33, 64, 1000, 100000}) {
+      std::vector<ElemType> A = Make(n, pattern), expect = A;
+      MergeSortBuffered(A.data() + 1, n, B.data());
+      ExpectSorted1(A, expect);
+    }
+  }
+}
+
+// Test the SIMD merge kernel and the MergeSort that uses it
+TEST_F(SortTest, MergeSortedInt_Sizes) {
+  srand(7);
+  for (int na : {0, 1, 7, 8, 9, 15, 16, 17, 100, 1000}) {
+    for (int nb : {0, 1, 7, 8, 9, 16, 23, 1000}) {
+      for (int range : {3, 1 << 30}) { // many duplicates / mostly distinct
+        std::vector<int> a(na), b(nb), out(na + nb), expect(na + nb);
+        for (int &x : a)
+          x = rand() % range - range / 2;
+        for (int &x : b)
+          x = rand() % range - range / 2;
+        if (na > 0)
+          a[0] = INT_MIN;
+        if (nb > 0)
+          b[nb - 1] = INT_MAX;
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        std::merge(a.begin(), a.end(), b.begin(), b.end(), expect.begin());
+        MergeSortedInt(a.data(), na, b.data(), nb, out.data());
+        ASSERT_EQ(expect, out) << "na=" << na << " nb=" << nb;
+      }
+    }
+  }
+}
+
+TEST_F(SortTest, MergeSort_Large) {
+  // Merge used a fixed 20-element buffer, so MergeSort only worked on tiny arrays
+  for (int pattern = 0; pattern < 5; pattern++) {
+    for (int n : {0, 1, 20, 21, 1000, 100000}) {
+      std::vector<ElemType> A = Make(n, pattern), expect = A;
+      MergeSort(A.data(), 1, n);
+      ExpectSorted1(A, expect);
+    }
+  }
+}
+
+TEST_F(SortTest, MergeSort_ConcurrentCalls) {
+  // the scratch buffer belongs to each call, so separate arrays can be sorted in parallel
+  std::vector<std::vector<ElemType>> A(4), expect(4);
+  for (int t = 0; t < 4; t++) {
+    A[t] = Make(200000, t % 5);
+    expect[t] = A[t];
+  }
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 4; t++)
+    workers.emplace_back([&A, t]() { MergeSort(A[t].data(), 1, 200000); });
+  for (std::thread &w : workers)
+    w.join();
+  for (int t = 0; t < 4; t++)
+    ExpectSorted1(A[t], expect[t]);
+
+  std::vector<ElemType> B = Make(1000, 0), C = B; // a short range at the end of the array
+  MergeSort(B.data(), 901, 1000);
+  std::sort(C.begin() + 901, C.end());
+  EXPECT_EQ(C, B);
+}
+
+// Test RadixSort family
+TEST_F(SortTest, RadixSort_Patterns) {
+  std::vector<ElemType> B(200000);
+  for (int pattern = 0; pattern < 5; pattern++) {
+    for (int n : {0, 1, 2, 64, 65, 1000, 200000}) {
+      std::vector<ElemType> A = Make(n, pattern), expect = A;
+      RadixSort(A.data() + 1, n, B.data());
+      ExpectSorted1(A, expect);
+
+      A = expect;
+      RadixSortInPlace(A.data() + 1, n);
+      ExpectSorted1(A, expect);
+
+      A = expect;
+      ParallelRadixSort(A.data() + 1, n, B.data(), 4);
+      ExpectSorted1(A, expect);
+    }
+  }
+}
+
+TEST_F(SortTest, RadixSort_SignBit) {
+  ElemType values[] = {0, -1, 2147483647, -2147483647 - 1, 1, -256, 256, 7};
+  const int n = sizeof(values) / sizeof(ElemType);
+  std::vector<ElemType> expect(values, values + n), B(n);
+  std::sort(expect.begin(), expect.end());
+
+  std::vector<ElemType> A(values, values + n);
+  RadixSort(A.data(), n, B.data());
+  EXPECT_EQ(expect, A);
+
+  A.assign(values, values + n);
+  RadixSortInPlace(A.data(), n);
+  EXPECT_EQ(expect, A);
+}
+
+// Test SmallSort function
+TEST_F(SortTest, SmallSort_AllSizes) {
+  for (int n = 0; n <= 100; n++) {
+    for (int pattern : {0, 2, 3}) {
+      std::vector<ElemType> A = Make(n, pattern), expect = A;
+      if (n > 0)
+        A[1] = 2147483647; // padding value must not leak into the result
+      expect = A;
+      SmallSort(A.data() + 1, n);
+      ExpectSorted1(A, expect);
+    }
+  }
+}
+
+TEST_F(SortTest, SmallSort_Leaves) {
+  std::vector<ElemType> A = Make(5000, 0), expect = A;
+  QuickSort(A.data(), 1, 5000);
+  ExpectSorted1(A, expect);
+
+  A = expect;
+  QuickSort2(A.data(), 1, 5000);
+  ExpectSorted1(A, expect);
+
+  std::sort(expect.begin() + 1, expect.end());
+  for (int k : {1, 17, 2500, 5000}) {
+    A = Make(5000, 0);
+    EXPECT_EQ(expect[k], KthElement(A.data(), 1, 5000, k));
+  }
+}
+
+// Test ExternalSort function
+TEST_F(SortTest, ExternalSort_MultiPass) {
+  const int n = 300000;
+  std::vector<ElemType> A = Make(n, 0);
+  char in[] = "/tmp/ext_in_XXXXXX", out[] = "/tmp/ext_out_XXXXXX";
+  close(mkstemp(in));
+  close(mkstemp(out));
+  FILE *f = fopen(in, "wb");
+  fwrite(A.data() + 1, sizeof(ElemType), n, f);
+  fclose(f);
+
+  for (bool async : {false, true}) {
+    // 64KB budget: 16K-element runs, fan-in 3, so several merge passes
+    ExternalSortStats stats;
+    ASSERT_TRUE(ExternalSort(in, out, 64 * 1024, &stats, async));
+    EXPECT_EQ(async ? 5 : 4, stats.passes);
+    for (int p = 0; p < stats.passes; p++) {
+      EXPECT_EQ((long long)n * sizeof(ElemType), stats.bytesRead[p]);
+      EXPECT_EQ((long long)n * sizeof(ElemType), stats.bytesWritten[p]);
+    }
+
+    std::vector<ElemType> B(n + 1);
+    f = fopen(out, "rb");
+    ASSERT_EQ((size_t)n, fread(B.data() + 1, sizeof(ElemType), n, f));
+    fclose(f);
+    ExpectSorted1(B, A);
+  }
+  unlink(in);
+  unlink(out);
+}
+
+TEST_F(SortTest, ExternalSort_HugeBudget) {
+  // a budget above 8 GiB must not be truncated to a tiny buffer
+  const int n = 100000;
+  std::vector<ElemType> A = Make(n, 0);
+  char in[] = "/tmp/ext_in_XXXXXX", out[] = "/tmp/ext_out_XXXXXX";
+  close(mkstemp(in));
+  close(mkstemp(out));
+  FILE *f = fopen(in, "wb");
+  fwrite(A.data() + 1, sizeof(ElemType), n, f);
+  fclose(f);
+
+  ExternalSortStats stats;
+  ASSERT_TRUE(ExternalSort(in, out, (size_t)16 << 30, &stats));
+  EXPECT_EQ(2, stats.passes); // one run, copied out by a single merge pass
+  std::vector<ElemType> B(n + 1);
+  f = fopen(out, "rb");
+  ASSERT_EQ((size_t)n, fread(B.data() + 1, sizeof(ElemType), n, f));
+  fclose(f);
+  ExpectSorted1(B, A);
+  unlink(in);
+  unlink(out);
+}
+
+TEST_F(SortTest, ExternalSort_Errors) {
+  EXPECT_FALSE(ExternalSort("/nonexistent/input", "/tmp/unused", 1 << 20));
+}
+
+// Test QuickSort3Way function
+TEST_F(SortTest, FlagPartition_Bounds) {
+  ElemType A[] = {5, 1, 5, 9, 3, 5, 7, 5, 0};
+  int lt, gt;
+  FlagPartition(A, 0, 8, 5, lt, gt);
+  EXPECT_EQ(3, lt);
+  EXPECT_EQ(6, gt);
+  for (int i = 0; i < lt; i++)
+    EXPECT_LT(A[i], 5);
+  for (int i = lt; i <= gt; i++)
+    EXPECT_EQ(5, A[i]);
+  for (int i = gt + 1; i < 9; i++)
+    EXPECT_GT(A[i], 5);
+}
+
+TEST_F(SortTest, QuickSort3Way_Patterns) {
+  for (int pattern = 0; pattern < 5; pattern++) {
+    for (int n : {0, 1, 2, 33, 1000, 200000}) {
+      std::vector<ElemType> A = Make(n, pattern), expect = A;
+      QuickSort3Way(A.data(), 1, n);
+      ExpectSorted1(A, expect);
+    }
+  }
+}
+
+// Test BlockPartition function
+TEST_F(SortTest, BlockPartition_SameContractAsPartition) {
+  for (int pattern = 0; pattern < 5; pattern++) {
+    for (int n : {1, 2, 3, 127, 128, 129, 1000, 5000}) {
+      std::vector<ElemType> A = Make(n, pattern), expect = A;
+      int p = BlockPartition(A.data(), 1, n);
+      ASSERT_GE(p, 1);
+      ASSERT_LE(p, n);
+      for (int i = 1; i < p; i++)
+        ASSERT_LE(A[i], A[p]);
+      for (int i = p + 1; i <= n; i++)
+        ASSERT_GE(A[i], A[p]);
+      EXPECT_EQ(expect[1], A[p]); // pivot is the first element
+      std::sort(A.begin() + 1, A.end()); // still a permutation of the input
+      ExpectSorted1(A, expect);
+    }
+  }
+}
+
+TEST_F(SortTest, BlockPartition_InSorts) {
+  for (int pattern = 0; pattern < 5; pattern++) {
+    std::vector<ElemType> A = Make(200000, pattern), expect = A;
+    IntroSort(A.data(), 200000, BlockPartition);
+    ExpectSorted1(A, expect);
+
+    A = expect;
+    ParallelQuickSort(A.data(), 200000, 4, BlockPartition);
+    ExpectSorted1(A, expect);
+  }
+}
+
+// Test NthElement and MultiSelect functions
+TEST_F(SortTest, NthElement_Patterns) {
+  for (int pattern = 0; pattern < 5; pattern++) {
+    std::vector<ElemType> expect = Make(100000, pattern);
+    std::vector<ElemType> sorted(expect.begin() + 1, expect.end());
+    std::sort(sorted.begin(), sorted.end());
+    for (int k : {0, 1, 500, 50000, 99000, 99999}) {
+      std::vector<ElemType> A(expect.begin() + 1, expect.end());
+      EXPECT_EQ(sorted[k], NthElement(A.data(), 100000, k));
+      for (int i = 0; i < k; i++)
+        ASSERT_LE(A[i], A[k]);
+      for (int i = k + 1; i < 100000; i++)
+        ASSERT_GE(A[i], A[k]);
+    }
+  }
+}
+
+TEST_F(SortTest, MultiSelect_Quantiles) {
+  const int n = 1000000;
+  for (int pattern = 0; pattern < 5; pattern++) {
+    std::vector<ElemType> expect = Make(n, pattern);
+    std::vector<ElemType> A(expect.begin() + 1, expect.end());
+    std::vector<ElemType> sorted = A;
+    std::sort(sorted.begin(), sorted.end());
+    int ks[] = {n * 999 / 1000, n / 2, n * 99 / 100, n * 9 / 10, n / 2, 0};
+    MultiSelect(A.data(), n, ks, 6);
+    for (int k : ks)
+      EXPECT_EQ(sorted[k], A[k]) << "rank " << k;
+  }
+}
+
+TEST_F(SortTest, NthElement_ClampsArguments) {
+  ElemType none[1] = {7};
+  EXPECT_EQ(0, NthElement(none, 0, 0)); // no elements: A is not read
+  EXPECT_EQ(7, none[0]);
+  std::vector<ElemType> A = {5, 3, 9, 1};
+  EXPECT_EQ(1, NthElement(A.data(), 4, -3));
+  EXPECT_EQ(9, NthElement(A.data(), 4, 10));
+}
+
+TEST_F(SortTest, MultiSelect_ManyRanks) {
+  const int n = 200000;
+  std::vector<ElemType> expect = Make(n, 0);
+  std::vector<ElemType> A(expect.begin() + 1, expect.end()), sorted = A;
+  std::sort(sorted.begin(), sorted.end());
+  std::vector<int> ks;
+  for (int i = 0; i < 20000; i++)
+    ks.push_back((int)((i * 7919LL) % (n + 100)) - 50); // some ranks fall outside [0, n)
+  MultiSelect(A.data(), n, ks.data(), (int)ks.size());
+  for (int k : ks) {
+    if (k >= 0 && k < n) {
+      ASSERT_EQ(sorted[k], A[k]) << "rank " << k;
+    }
+  }
+}
+
+TEST_F(SortTest, HeapSort_MatchesBinaryHeapSort) {
+  for (int pattern = 0; pattern < 5; pattern++) {
+    for (int n : {0, 1, 2, 3, 4, 5, 17, 1000, 100000}) {
+      std::vector<ElemType> A = Make(n, pattern), B = A, C = A;
+      A[0] = 7777;
+      HeapSort(A.data(), n);
+      BinaryHeapSort(C.data(), n);
+      EXPECT_EQ(7777, A[0]); // the 4-ary version no longer needs A[0]
+      C[0] = 7777;
+      EXPECT_EQ(C, A);
+      ExpectSorted1(A, B);
+    }
+  }
+}
+
+TEST_F(SortTest, AdaptiveSort_Patterns) {
+  for (int pattern = 0; pattern < 5; pattern++) {
+    for (int n : {0, 1, 2, 31, 32, 33, 100, 1000, 100000}) {
+      std::vector<ElemType> expect = Make(n, pattern);
+      std::vector<ElemType> A(expect.begin() + 1, expect.end());
+      std::sort(expect.begin() + 1, expect.end());
+      AdaptiveSort(A.data(), n);
+      ASSERT_TRUE(std::equal(A.begin(), A.end(), expect.begin() + 1))
+          << "pattern " << pattern << " n " << n;
+    }
+  }
+}
+
+TEST_F(SortTest, AdaptiveSort_NearlySortedRuns) {
+  // sorted blocks of varying length, some descending, plus local swaps:
+  // exercises run detection, galloping and both merge directions
+  srand(99);
+  std::vector<ElemType> A;
+  while (A.size() < 200000) {
+    int len = rand() % 5000 + 1, base = rand() % 100000;
+    bool desc = rand() % 3 == 0;
+    for (int i = 0; i < len; i++)
+      A.push_back(desc ? base - i / 2 : base + i / 2);
+  }
+  for (int i = 0; i + 8 < (int)A.size(); i += 97)
+    std::swap(A[i], A[i + rand() % 8]);
+  std::vector<ElemType> expect = A;
+  std::sort(expect.begin(), expect.end());
+  AdaptiveSort(A.data(), (int)A.size());
+  EXPECT_EQ(expect, A);
+}
+
+TEST_F(SortTest, ArgSort_StableOrder) {
+  for (int pattern = 0; pattern < 5; pattern++) {
+    for (int n : {0, 1, 2, 1000, 100000}) {
+      std::vector<ElemType> keys = Make(n, pattern);
+      keys.erase(keys.begin());
+      std::vector<int> idx(n), expect(n);
+      for (int i = 0; i < n; i++)
+        expect[i] = i;
+      std::stable_sort(expect.begin(), expect.end(),
+                       [&](int a, int b) { return keys[a] < keys[b]; });
+      ArgSort(keys.data(), n, idx.data());
+      ASSERT_EQ(expect, idx) << "pattern " << pattern << " n " << n;
+    }
+  }
+}
+
+TEST_F(SortTest, SortByKey_MovesPayload) {
+  struct Wide { // payload wide enough that moving it matters
+    int origin;
+    ElemType key;
+    char pad[56];
+  };
+  const int n = 50000;
+  std::vector<ElemType> keys = Make(n, 3); // few unique: stability is visible
+  keys.erase(keys.begin());
+  std::vector<Wide> payload(n);
+  for (int i = 0; i < n; i++) {
+    payload[i].origin = i;
+    payload[i].key = keys[i];
+    memset(payload[i].pad, i & 0x7f, sizeof(payload[i].pad));
+  }
+  SortByKey(keys.data(), payload.data(), n, sizeof(Wide));
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(keys[i], payload[i].key);
+    ASSERT_EQ(payload[i].origin & 0x7f, payload[i].pad[55]);
+    if (i > 0) {
+      ASSERT_LE(keys[i - 1], keys[i]);
+      if (keys[i - 1] == keys[i]) {
+        ASSERT_LT(payload[i - 1].origin, payload[i].origin);
+      }
+    }
+  }
+}
+
+TEST_F(SortTest, ApplyPermutation_KeepsIndex) {
+  std::vector<int> idx = {3, 0, 4, 1, 2, 5};
+  std::vector<ElemType> A = {10, 11, 12, 13, 14, 15};
+  std::vector<int> before = idx;
+  ApplyPermutation(A.data(), sizeof(ElemType), idx.data(), 6);
+  EXPECT_EQ(std::vector<ElemType>({13, 10, 14, 11, 12, 15}), A);
+  EXPECT_EQ(before, idx);
+}
+
+TEST_F(SortTest, PartialSort_Prefix) {
+  for (int pattern = 0; pattern < 5; pattern++) {
+    for (int k : {0, 1, 10, 999, 1000, 5000}) {
+      std::vector<ElemType> expect = Make(1000, pattern);
+      std::vector<ElemType> A(expect.begin() + 1, expect.end());
+      std::sort(expect.begin() + 1, expect.end());
+      PartialSort(A.data(), 1000, k);
+      int m = k < 1000 ? k : 1000;
+      ASSERT_TRUE(std::equal(A.begin(), A.begin() + m, expect.begin() + 1))
+          << "pattern " << pattern << " k " << k;
+      std::sort(A.begin(), A.end()); // the rest is still the same multiset
+      ASSERT_TRUE(std::equal(A.begin(), A.end(), expect.begin() + 1));
+    }
+  }
+}
+
+TEST_F(SortTest, TopK_Chunked) {
+  const int n = 300000;
+  for (int pattern = 0; pattern < 5; pattern++) {
+    std::vector<ElemType> A = Make(n, pattern);
+    A.erase(A.begin());
+    std::vector<ElemType> sorted = A;
+    std::sort(sorted.begin(), sorted.end());
+    for (bool largest : {false, true}) {
+      for (int k : {0, 1, 100, 4096}) {
+        TopKState S;
+        ASSERT_TRUE(TopKInit(S, k, largest));
+        for (int i = 0; i < n; i += 7777) // uneven chunks
+          TopKPush(S, A.data() + i, n - i < 7777 ? n - i : 7777);
+        std::vector<ElemType> out(k + 1);
+        ASSERT_EQ(k, TopKResult(S, out.data()));
+        TopKDestroy(S);
+        for (int i = 0; i < k; i++)
+          ASSERT_EQ(largest ? sorted[n - 1 - i] : sorted[i], out[i])
+              << "pattern " << pattern << " k " << k << " at " << i;
+      }
+    }
+  }
+}
+
+TEST_F(SortTest, TopK_FewerThanK) {
+  ElemType A[] = {5, -1, 3};
+  ElemType out[10];
+  EXPECT_EQ(3, TopK(A, 3, 10, out, true));
+  EXPECT_EQ(5, out[0]);
+  EXPECT_EQ(3, out[1]);
+  EXPECT_EQ(-1, out[2]);
+  TopKState S;
+  EXPECT_FALSE(TopKInit(S, -1));
+}
+
+TEST_F(SortTest, ParallelSampleSort_MatchesMergeSort) {
+  const int n = 1 << 20; // above the sequential cutoff
+  for (int pattern = 0; pattern < 5; pattern++) {
+    for (int threads : {1, 3, 8}) {
+      std::vector<ElemType> A = Make(n, pattern);
+      A.erase(A.begin());
+      std::vector<ElemType> expect = A, B(n), C(n);
+      MergeSortBuffered(expect.data(), n, C.data());
+      ParallelSampleSort(A.data(), n, B.data(), threads);
+      ASSERT_EQ(expect, A) << "pattern " << pattern << " threads " << threads;
+    }
+  }
+}
+
+TEST_F(SortTest, ParallelSampleSort_AllEqualAndSmall) {
+  std::vector<ElemType> A(300000, 42), B(300000);
+  ParallelSampleSort(A.data(), 300000, B.data(), 4); // all land in one equality bucket
+  EXPECT_EQ(std::vector<ElemType>(300000, 42), A);
+  std::vector<ElemType> S = {3, -1, 2}, T(3);
+  ParallelSampleSort(S.data(), 3, T.data(), 4);
+  EXPECT_EQ(std::vector<ElemType>({-1, 2, 3}), S);
+}
+
+TEST_F(SortTest, SortStats_Fields) {
+  std::vector<ElemType> A = Make(100000, 0);
+  SortStats st = ProfileSort([&]() { IntroSort(A.data(), 100000); });
+  EXPECT_TRUE(isSorted(&A[1], 100000));
+#ifdef SORT_INSTRUMENT
+  EXPECT_GT(st.comparisons, 100000LL * 16); // at least ~n log2 n
+  EXPECT_GT(st.moves, 0);
+#else
+  EXPECT_EQ(-1, st.comparisons);
+  EXPECT_EQ(-1, st.moves);
+#endif
+  EXPECT_GT(st.ns, 0);
+  // hardware counters are -1 where no PMU is available, positive otherwise
+  EXPECT_TRUE(st.cycles == -1 || st.cycles > 0);
+  EXPECT_TRUE(st.instructions == -1 || st.instructions > 0);
+  for (int c = 0; c < SORT_PERF_COUNTERS; c++)
+    EXPECT_EQ(-1, st.perfFd[c]); // all descriptors closed
+}
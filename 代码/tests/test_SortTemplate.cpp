@@ -0,0 +1,150 @@
+#include "SortTemplate.h"
+#include <algorithm>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct Record { // wide record sorted by one field
+  long long id;
+  double score;
+  int seq; // original position, for stability checks
+  char name[16];
+};
+
+class SortTemplateTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    srand(2024);
+    for (int i = 0; i < 3000; i++) {
+      Record r;
+      r.id = ((long long)rand() << 20) - ((long long)rand() << 30);
+      r.score = (rand() % 200 - 100) / 7.0;
+      r.seq = i;
+      snprintf(r.name, sizeof(r.name), "r%d", rand() % 50);
+      records.push_back(r);
+    }
+  }
+
+  std::vector<Record> records;
+};
+
+// Every algorithm must sort 64-bit keys through a member projection
+TEST_F(SortTemplateTest, AllAlgorithms_ProjectedKey) {
+  typedef void (*Algo)(Record *, int, std::less<>, long long Record::*);
+  Algo algos[] = {
+      gsort::InsertSort, gsort::HalfInsertSort, gsort::ShellSort,
+      gsort::BubbleSort, gsort::Bubble2Sort,    gsort::SelectSort,
+      gsort::HeapSort,   gsort::QuickSort,      gsort::IntroSort,
+      gsort::QuickSort3Way, gsort::MergeSort,   gsort::Sort};
+  for (Algo algo : algos) {
+    std::vector<Record> v = records;
+    algo(v.data(), (int)v.size(), std::less<>(), &Record::id);
+    for (size_t i = 1; i < v.size(); i++)
+      ASSERT_LE(v[i - 1].id, v[i].id);
+  }
+}
+
+TEST_F(SortTemplateTest, Doubles_CustomComparator) {
+  std::vector<double> v;
+  for (int i = 0; i < 1000; i++)
+    v.push_back((rand() % 2001 - 1000) / 3.0);
+  std::vector<double> expect = v;
+  std::sort(expect.begin(), expect.end(), std::greater<double>());
+
+  std::vector<double> a = v;
+  gsort::IntroSort(a.begin(), a.end(),
+                   [](double x, double y) { return x > y; });
+  EXPECT_EQ(expect, a);
+
+  a = v;
+  gsort::Sort(a.begin(), a.end(), std::greater<>()); // radix path, descending
+  EXPECT_EQ(expect, a);
+
+  a = v;
+  gsort::Sort(a.data(), (int)a.size()); // radix path, ascending
+  std::reverse(expect.begin(), expect.end());
+  EXPECT_EQ(expect, a);
+}
+
+TEST_F(SortTemplateTest, StableSorts_KeepEqualKeysInOrder) {
+  // score has only 200 distinct values
+  std::vector<Record> a = records, b = records, c = records;
+  gsort::MergeSort(a.begin(), a.end(), std::less<>(), &Record::score);
+  gsort::RadixSort(b.begin(), b.end(), &Record::score);
+  gsort::InsertSort(c.begin(), c.end(), std::less<>(), &Record::score);
+  for (const std::vector<Record> *v : {&a, &b, &c}) {
+    for (size_t i = 1; i < v->size(); i++) {
+      ASSERT_LE((*v)[i - 1].score, (*v)[i].score);
+      if ((*v)[i - 1].score == (*v)[i].score) {
+        ASSERT_LT((*v)[i - 1].seq, (*v)[i].seq);
+      }
+    }
+  }
+}
+
+TEST_F(SortTemplateTest, RadixSort_KeyTypes) {
+  std::vector<signed char> c = {5, -3, 127, -128, 0, -1, 1};
+  gsort::RadixSort(c.begin(), c.end());
+  EXPECT_TRUE(std::is_sorted(c.begin(), c.end()));
+
+  std::vector<unsigned long long> u;
+  std::vector<float> f;
+  for (int i = 0; i < 5000; i++) {
+    u.push_back(((unsigned long long)rand() << 33) ^ rand());
+    f.push_back((rand() % 10000 - 5000) * 0.37f);
+  }
+  f.push_back(-0.0f);
+  gsort::RadixSort(u.data(), (int)u.size());
+  gsort::RadixSort(f.data(), (int)f.size());
+  EXPECT_TRUE(std::is_sorted(u.begin(), u.end()));
+  EXPECT_TRUE(std::is_sorted(f.begin(), f.end()));
+}
+
+TEST_F(SortTemplateTest, NonArithmeticKey_FallsBackToIntroSort) {
+  std::vector<std::string> v = {"pear", "apple", "fig", "kiwi", "banana"};
+  gsort::Sort(v.begin(), v.end());
+  EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+}
+
+TEST_F(SortTemplateTest, MoveOnlyElements) {
+  // the pivot must be moved or referenced, never copied
+  auto deref = [](const std::unique_ptr<int> &p) { return *p; };
+  std::vector<std::unique_ptr<int>> a, b, c;
+  for (const Record &r : records) {
+    int key = (int)(r.id % 100); // many equal keys for the three-way partition
+    a.push_back(std::make_unique<int>(key));
+    b.push_back(std::make_unique<int>(key));
+    c.push_back(std::make_unique<int>(key));
+  }
+  gsort::QuickSort3Way(a.begin(), a.end(), std::less<>(), deref);
+  gsort::IntroSort(b.begin(), b.end(), std::less<>(), deref);
+  for (size_t i = 1; i < a.size(); i++) {
+    ASSERT_LE(*a[i - 1], *a[i]);
+    ASSERT_LE(*b[i - 1], *b[i]);
+  }
+  size_t k = c.size() / 3;
+  gsort::NthElement(c.begin(), c.begin() + k, c.end(), std::less<>(), deref);
+  EXPECT_EQ(*a[k], *c[k]);
+  for (size_t i = 0; i < c.size(); i++) {
+    if (i < k) {
+      ASSERT_LE(*c[i], *c[k]);
+    } else {
+      ASSERT_GE(*c[i], *c[k]);
+    }
+  }
+}
+
+TEST_F(SortTemplateTest, NthElement_Test) {
+  std::vector<Record> v = records;
+  std::vector<long long> ids;
+  for (const Record &r : v)
+    ids.push_back(r.id);
+  std::sort(ids.begin(), ids.end());
+  for (int k : {0, 7, 1500, 2999}) {
+    std::vector<Record> a = v;
+    gsort::NthElement(a.data(), (int)a.size(), k, std::less<>(), &Record::id);
+    EXPECT_EQ(ids[k], a[k].id);
+  }
+}
@@ -0,0 +1,74 @@
+#include "String.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+static std::vector<std::string> MakeStrings(int n) { // URL-like keys with long shared prefixes
+  static const char *hosts[] = {"http://www.example.com/", "http://www.example.org/",
+                                "https://a.b/", ""};
+  srand(42);
+  std::vector<std::string> v;
+  for (int i = 0; i < n; i++) {
+    std::string s = hosts[rand() % 4];
+    int depth = rand() % 4;
+    for (int d = 0; d < depth; d++) {
+      s += "dir" + std::to_string(rand() % 5) + "/";
+    }
+    if (rand() % 3)
+      s += std::to_string(rand() % 50);
+    v.push_back(s);
+  }
+  v.push_back("");
+  v.push_back("");
+  v.push_back(std::string(MAXLEN - 2, 'z'));
+  return v;
+}
+
+static void CheckSString(StrSortMethod method) {
+  std::vector<std::string> expect = MakeStrings(3000);
+  int n = (int)expect.size();
+  std::vector<SString> store(n);
+  std::vector<SString *> ptr(n);
+  for (int i = 0; i < n; i++) {
+    store[i].length = (int)expect[i].size();
+    memcpy(store[i].ch + 1, expect[i].data(), expect[i].size());
+    ptr[i] = &store[i];
+  }
+  std::sort(expect.begin(), expect.end());
+  StrSort(ptr.data(), n, method);
+  for (int i = 0; i < n; i++)
+    ASSERT_EQ(expect[i], std::string(ptr[i]->ch + 1, ptr[i]->length)) << i;
+}
+
+static void CheckHString(StrSortMethod method) {
+  std::vector<std::string> expect = MakeStrings(3000);
+  int n = (int)expect.size();
+  std::vector<HString> a(n);
+  for (int i = 0; i < n; i++) {
+    a[i].length = (int)expect[i].size();
+    a[i].ch = (char *)malloc(a[i].length + 1);
+    memcpy(a[i].ch + 1, expect[i].data(), expect[i].size());
+  }
+  std::sort(expect.begin(), expect.end());
+  StrSort(a.data(), n, method);
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(expect[i], std::string(a[i].ch + 1, a[i].length)) << i;
+    if (i > 0) {
+      ASSERT_LE(StrCompare(a[i - 1], a[i]), 0);
+    }
+  }
+  for (int i = 0; i < n; i++)
+    free(a[i].ch);
+}
+
+TEST(StringSortTest, SString_MultikeyQuickSort) { CheckSString(STR_SORT_MKQS); }
+
+TEST(StringSortTest, SString_MsdRadix) { CheckSString(STR_SORT_RADIX); }
+
+TEST(StringSortTest, HString_BothMethods) {
+  CheckHString(STR_SORT_MKQS);
+  CheckHString(STR_SORT_RADIX);
+}